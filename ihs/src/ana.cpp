@@ -12,6 +12,8 @@
 #include <snappy.h>
 #include <zlib.h> // 用于CRC32校验
 
+#include "live_feed.h" // obr: 解压后的数据块直接驱动各证券订单簿
+
 // 常量定义
 const int PORT = 8888;
 const int MAX_UDP_SIZE = 65507;
@@ -37,18 +39,25 @@ std::atomic<bool> running{true};
 // 日志文件
 std::ofstream seqno_log("seqno.log", std::ios::binary);
 
-// Algo模块回调函数示例
-void algo_callback(const std::string& data) {
-    // 这里添加实际处理逻辑
+// 实时订单簿，只在处理线程中访问
+// 同一路行情里主板与创业板证券混在一起，按证券代码分别选用重建规则
+orderbook::LiveFeed live_feed(orderbook::MarketType::UNKNOWN);
+
+// Algo模块回调：解压后的数据块就地解码为委托/成交事件并更新订单簿
+void algo_callback(const char* data, size_t size) {
+    live_feed.onBlock(data, size);
     static int count = 0;
     if (++count % 1000 == 0) {
-        std::cout << "Processed " << count << " market data blocks\n";
+        std::cout << "Processed " << count << " market data blocks, "
+                  << live_feed.events() << " events, "
+                  << live_feed.securities() << " securities\n";
     }
 }
 
 // 数据包处理线程
 void process_thread_func() {
     uint32_t expected_seqno = 1; // 起始序列号
+    std::vector<char> uncompressed; // 解压缓冲区，跨数据块复用
 
     while (running) {
         std::unique_lock<std::mutex> lock(queue_mutex);
@@ -56,7 +65,7 @@ void process_thread_func() {
         
         if (!running) break;
 
-        auto [seqno, packet] = data_queue.front();
+        auto [seqno, packet] = std::move(data_queue.front());
         data_queue.pop();
         lock.unlock();
 
@@ -68,8 +77,8 @@ void process_thread_func() {
             exit(EXIT_FAILURE);
         }
 
-        // 解析数据块
-        size_t offset = 0;
+        // 解析数据块（跳过包头的序列号）
+        size_t offset = SEQNO_SIZE;
         while (offset < packet.size()) {
             // 提取长度字段
             if (offset + LENGTH_FIELD_SIZE > packet.size()) {
@@ -88,17 +97,26 @@ void process_thread_func() {
                 break;
             }
 
-            // Snappy解压缩
-            std::string uncompressed;
+            // Snappy解压缩到复用的缓冲区，避免每块分配 std::string
             const char* compressed_data = packet.data() + offset;
-            if (!snappy::Uncompress(compressed_data, block_len, &uncompressed)) {
+            size_t uncompressed_len = 0;
+            if (!snappy::GetUncompressedLength(compressed_data, block_len,
+                                               &uncompressed_len)) {
+                std::cerr << "Snappy decompression failed at seqno: " << seqno << std::endl;
+                offset += block_len;
+                continue;
+            }
+            if (uncompressed.size() < uncompressed_len) {
+                uncompressed.resize(uncompressed_len);
+            }
+            if (!snappy::RawUncompress(compressed_data, block_len, uncompressed.data())) {
                 std::cerr << "Snappy decompression failed at seqno: " << seqno << std::endl;
                 offset += block_len;
                 continue;
             }
 
             // 传递给算法模块
-            algo_callback(uncompressed);
+            algo_callback(uncompressed.data(), uncompressed_len);
             offset += block_len;
         }
 
@@ -190,16 +208,13 @@ int test() {
         // 记录序列号
         seqno_log.write(reinterpret_cast<const char*>(&seqno), sizeof(seqno));
         
-        // 移除非序列号数据
-        std::vector<char> payload(
-            buffer.begin() + SEQNO_SIZE,
-            buffer.begin() + recv_len
-        );
+        // 整包移入处理队列，序列号由处理线程跳过，不再复制负载
+        buffer.resize(recv_len);
 
         // 添加到处理队列
         {
             std::lock_guard<std::mutex> lock(queue_mutex);
-            data_queue.emplace(seqno, std::move(payload));
+            data_queue.emplace(seqno, std::move(buffer));
         }
         queue_cv.notify_one();
     }
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "TcpApi.hpp"
+
+// 新建连接的速率：客户端 connect 后等服务端 onAccepted 回一个字节，再以 RST 关闭
+// range(0) 为 0 时由 MainReactor accept 后转交 SubReactor，为 1 时各 SubReactor 用 SO_REUSEPORT 自己 accept
+
+namespace {
+
+constexpr int kPorts[] = {18025, 18026};
+
+class GreetSpi : public TcpSpi {
+public:
+    void onAccepted(std::shared_ptr<Connection> conn) override {
+        conn->send("!", 1);
+    }
+    void onDisconnected(std::shared_ptr<Connection>, int, const char*) override {}
+    void onMessage(std::shared_ptr<Connection>, SimpleBuffer& buffer) override {
+        buffer.advance(buffer.size());
+    }
+};
+
+// 服务端只启动一次，进程退出前不析构
+int serverPort(int reusePort) {
+    static GreetSpi spi;
+    static bool started[2] = {};
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!started[reusePort]) {
+        spdlog::set_level(spdlog::level::err);
+        auto* api = new TcpApi;
+        api->bindAddress("127.0.0.1", kPorts[reusePort], reusePort != 0);
+        api->registerSpi(&spi);
+        std::thread([api] { api->run(); }).detach();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        started[reusePort] = true;
+    }
+    return kPorts[reusePort];
+}
+
+int dial(int port, bool nonblocking) {
+    int fd = socket(AF_INET, SOCK_STREAM | (nonblocking ? SOCK_NONBLOCK : 0), 0);
+    // RST 关闭，客户端不留 TIME_WAIT，跑多轮也不会耗尽本地端口
+    linger lg = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        std::abort();
+    }
+    return fd;
+}
+
+// 每个线程依次建立连接，等到服务端的问候后关闭
+void BM_ConnectRate(benchmark::State& state) {
+    int port = serverPort(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        int fd = dial(port, false);
+        char c;
+        if (read(fd, &c, 1) != 1) {
+            std::abort();
+        }
+        close(fd);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConnectRate)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+// 同时发起 range(1) 个连接，全部收到问候才算完成；监听 fd 是边沿触发，积压的连接必须一次取完
+void BM_ConnectBurst(benchmark::State& state) {
+    int port = serverPort(static_cast<int>(state.range(0)));
+    size_t count = static_cast<size_t>(state.range(1));
+    std::vector<pollfd> fds(count);
+    for (auto _ : state) {
+        for (auto& p : fds) {
+            p.fd = dial(port, true);
+            p.events = POLLIN;
+        }
+        for (size_t done = 0; done < count;) {
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                std::abort();
+            }
+            for (auto& p : fds) {
+                if (p.fd >= 0 && (p.revents & POLLIN)) {
+                    close(p.fd);
+                    p.fd = -1;
+                    ++done;
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_ConnectBurst)->ArgsProduct({{0, 1}, {64, 256}})->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+#include <benchmark/benchmark.h>
+#include <arpa/inet.h>
+#include <future>
+#include <thread>
+#include <vector>
+#include "TcpApi.hpp"
+
+// 非 SubReactor 线程调用 Connection::send 到对端 socket 收齐数据的耗时
+// 服务端和客户端在同一进程内，经回环网卡
+
+namespace {
+
+constexpr int kPort = 18022;
+
+class CaptureSpi : public TcpSpi {
+public:
+    void onAccepted(std::shared_ptr<Connection> conn) override {
+        accepted_.set_value(conn);
+    }
+    void onDisconnected(std::shared_ptr<Connection>, int, const char*) override {}
+    void onMessage(std::shared_ptr<Connection>, SimpleBuffer& buffer) override {
+        buffer.advance(buffer.size());
+    }
+
+    std::shared_ptr<Connection> connection() {
+        return accepted_.get_future().get();
+    }
+
+private:
+    std::promise<std::shared_ptr<Connection>> accepted_;
+};
+
+// 服务端只启动一次，进程退出前不析构
+struct Loopback {
+    Loopback() {
+        spdlog::set_level(spdlog::level::err);
+        auto* api = new TcpApi;
+        api->bindAddress("127.0.0.1", kPort);
+        api->registerSpi(&spi);
+        std::thread([api] { api->run(); }).detach();
+
+        client = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(kPort);
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        while (connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        conn = spi.connection();
+    }
+
+    void receive(std::vector<char>& buffer, size_t len) {
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = read(client, buffer.data() + got, len - got);
+            if (n <= 0) {
+                std::abort();
+            }
+            got += n;
+        }
+    }
+
+    CaptureSpi spi;
+    int client = -1;
+    std::shared_ptr<Connection> conn;
+};
+
+Loopback& loopback() {
+    static Loopback instance;
+    return instance;
+}
+
+// 一次发送一条消息，等对端收到后再发下一条
+void BM_CrossThreadSendLatency(benchmark::State& state) {
+    Loopback& lb = loopback();
+    size_t len = static_cast<size_t>(state.range(0));
+    std::vector<char> message(len, 'x');
+    std::vector<char> received(len);
+    for (auto _ : state) {
+        lb.conn->send(message.data(), len);
+        lb.receive(received, len);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+BENCHMARK(BM_CrossThreadSendLatency)->Arg(16)->Arg(256)->Arg(4096)->UseRealTime();
+
+// 连发 range(0) 条 16 字节消息再全部收完，衡量唤醒合并
+void BM_CrossThreadSendBurst(benchmark::State& state) {
+    Loopback& lb = loopback();
+    size_t count = static_cast<size_t>(state.range(0));
+    char message[16] = {};
+    std::vector<char> received(count * sizeof(message));
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; ++i) {
+            lb.conn->send(message, sizeof(message));
+        }
+        lb.receive(received, received.size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_CrossThreadSendBurst)->Arg(8)->Arg(64)->Arg(1024)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
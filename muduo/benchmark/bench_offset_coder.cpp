@@ -0,0 +1,113 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OffsetCoder.hpp"
+
+// 帧体长度 64B ~ 64KB，按本机可用的每种实现各跑一遍
+// 原地解码对应接收缓冲上的 Codec::decodeBody，异地编码对应 Codec::encode
+
+namespace {
+
+// 改造前的逐字节实现，作为对照
+void encodeBranchy(const char* in, char* out, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = static_cast<char>(in[i] + (i % 2 ? 0x51 : 0x4A));
+    }
+}
+
+void decodeBranchy(const char* in, char* out, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        out[i] = static_cast<char>(static_cast<uint8_t>(in[i]) - (i % 2 ? 0x51 : 0x4A));
+    }
+}
+
+std::vector<char> payload(size_t len) {
+    std::vector<char> data(len);
+    for (size_t i = 0; i < len; ++i) {
+        data[i] = static_cast<char>(i * 131 + 7);
+    }
+    return data;
+}
+
+void BM_Encode(benchmark::State& state, OffsetCoder::Transform encode) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::vector<char> in = payload(len);
+    std::vector<char> out(len);
+    for (auto _ : state) {
+        encode(in.data(), out.data(), len);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+
+void BM_DecodeInPlace(benchmark::State& state, OffsetCoder::Transform decode) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::vector<char> data = payload(len);
+    for (auto _ : state) {
+        decode(data.data(), data.data(), len);
+        benchmark::DoNotOptimize(data.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * len));
+}
+
+void payloadSizes(benchmark::internal::Benchmark* bench) {
+    // 覆盖各实现的尾部处理：非 16/32/64 整数倍的长度也测一档
+    bench->Arg(61);
+    for (int64_t len = 64; len <= 64 * 1024; len *= 4) {
+        bench->Arg(len);
+    }
+}
+
+// 各实现与标量实现逐字节对照：覆盖每种向量宽度的尾部长度和非对齐地址，
+// 异地编码与原地解码都要还原出原文，不一致时不跑基准直接退出
+bool sameAsScalar(const OffsetCoder::Kernel& kernel, const OffsetCoder::Kernel& scalar) {
+    for (size_t len = 0; len <= 300; ++len) {
+        for (size_t shift = 0; shift < 4; ++shift) {
+            std::vector<char> in = payload(len + shift);
+            std::vector<char> expected(len + shift);
+            std::vector<char> actual(len + shift);
+            scalar.encode(in.data() + shift, expected.data() + shift, len);
+            kernel.encode(in.data() + shift, actual.data() + shift, len);
+            if (std::memcmp(expected.data(), actual.data(), len + shift) != 0) {
+                std::fprintf(stderr, "%s encode differs from scalar at len %zu shift %zu\n", kernel.name, len, shift);
+                return false;
+            }
+            kernel.decode(actual.data() + shift, actual.data() + shift, len);
+            if (std::memcmp(in.data() + shift, actual.data() + shift, len) != 0) {
+                std::fprintf(stderr, "%s decode does not restore len %zu shift %zu\n", kernel.name, len, shift);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool registerAll() {
+    std::vector<OffsetCoder::Kernel> kernels = OffsetCoder::supported();
+    for (const auto& kernel : kernels) {
+        if (!sameAsScalar(kernel, kernels.front())) {
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    benchmark::RegisterBenchmark("BM_Encode/branchy", BM_Encode, encodeBranchy)->Apply(payloadSizes);
+    benchmark::RegisterBenchmark("BM_DecodeInPlace/branchy", BM_DecodeInPlace, decodeBranchy)->Apply(payloadSizes);
+    for (const auto& kernel : kernels) {
+        benchmark::RegisterBenchmark((std::string("BM_Encode/") + kernel.name).c_str(),
+                                     BM_Encode, kernel.encode)->Apply(payloadSizes);
+        benchmark::RegisterBenchmark((std::string("BM_DecodeInPlace/") + kernel.name).c_str(),
+                                     BM_DecodeInPlace, kernel.decode)->Apply(payloadSizes);
+    }
+    return true;
+}
+
+[[maybe_unused]] const bool registered = registerAll();
+
+} // namespace
+
+BENCHMARK_MAIN();
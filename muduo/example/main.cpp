@@ -15,6 +15,8 @@
 #include <optional>
 #include "TcpSpi.hpp"
 #include "TcpApi.hpp"
+#include "Codec.hpp"
+#include "OffsetCoder.hpp"
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/async.h"
@@ -66,137 +68,45 @@ size_t encoder(uint8_t type, const char* data, uint32_t data_len, char* output,
 	auto total_len = 5 + data_len;
     std::memcpy(output + 1, &total_len, 4);
 
-    for (uint32_t i = 0; i < data_len; ++i) {
-        output[5 + i] = static_cast<char>(data[i] + (i % 2 ? 0x51 : 0x4A));
-    }
+    OffsetCoder::encode(data, output + 5, data_len);
     return total_len;
 }
 
 
-class Coder {
+class CubeServer: public FrameSpi {
 public:
-	std::pair<uint8_t, int> getMessageTypeLength(const char * data) {
-		if (data == nullptr) {
-			std::abort();
-		}
-		uint8_t type = static_cast<uint8_t>(data[0]);
-		uint32_t len;
-		std::memcpy(&len, data + 1, 4);
-		return std::make_pair(type, len);
-	}
-
-	std::pair<int, bool> decode(SimpleBuffer& buffer) {
-		if (buffer.size() < kHeaderLen) {
-			return {0, false};
-		}
-		const char* data = buffer.data();
-		auto [type, messageLen] = getMessageTypeLength(data);
-		if (type != 2) {
-			// spdlog::warn("Unexpected message type: {}", type);
-			// close connection
-			return {0, false};
-		}
-		if (messageLen < 0) {
-			// spdlog::warn("Invalid message length: {}", messageLen);
-			return {0, false};
-		} else if (buffer.size() >= messageLen) {
-			buffer.advance(kHeaderLen);
-			auto timestamp = decodeTimeStamp(buffer.data(), messageLen - kHeaderLen);
-            auto timediff = getMicroTimestamp() - timestamp;
-            spdlog::warn("timeSinceSend cost: {}us", timediff);
-			return {messageLen - kHeaderLen, true};
-		} else {
-            // spdlog::warn("Buffer size {} is less than expected message length {}", buffer.size(), messageLen);
-			return {0, false};
-		}
+	void onAccepted(std::shared_ptr<Connection> conn) override {
+        spdlog::info("onAccepted called with fd: {}", conn->fdWrapper().fd());
 	}
 
-	void encodeHeaderWithTimeStamp(std::vector<char>& output, uint32_t totalLen) {
-		ScopedTimer timer(__func__);
-		output[0] = 3;
-		std::memcpy(output.data() + 1, &totalLen, 4);
-		auto current_time = getMicroTimestamp();
-
-		constexpr uint8_t kOffsets[2] = {0x4A, 0x51};
-
-		for (int i = 0; i < 8; ++i) {
-			output[5 + i] = static_cast<char>((current_time >> (i * 8)) + kOffsets[i & 1]);
-		}
+	void onDisconnected(std::shared_ptr<Connection> conn, int reason, const char* reason_str) override {
+        spdlog::info("Connection disconnected on fd: {}, reason: {} {}", conn->fdWrapper().fd(), reason, reason_str);
 	}
 
-	void encodeData(Data& data, std::vector<char>& output) {
-		output.resize(sizeof(Data) + 5);
-		output[0] = 1; // type
-		uint32_t total_len = sizeof(Data) + 5;
-		std::memcpy(output.data() + 1, &total_len, 4);
-		std::memcpy(output.data() + 5, &data, sizeof(Data));
-		for (size_t i = 0; i < sizeof(Data); ++i) {
-			output[i + 5] += i % 2 ? 0x51 : 0x4A;
+	void onFrame(std::shared_ptr<Connection> conn, Frame& frame) override {
+		// 请求帧体以 8 字节发送时间戳开头
+		if (frame.type != 2 || frame.length < 8) {
+			return;
 		}
-	}
+		uint64_t timestamp;
+		std::memcpy(&timestamp, frame.body, 8);
+		spdlog::warn("timeSinceSend cost: {}us", getMicroTimestamp() - timestamp);
 
-private:
-	uint64_t decodeTimeStamp(const char* data, size_t length) {
-        ScopedTimer timer(__func__);
-		if (!data) {
-			std::abort();
-        }
-		uint64_t decoded_timestamp = 0;
-		for (int i = 0; i < 8; ++i) {
-			uint8_t decoded_byte = data[i] -  (i % 2 ? 0x51 : 0x4A);
-			decoded_timestamp |= (static_cast<uint64_t>(decoded_byte) << (i * 8));
+		// 应答帧体：服务端时间戳 + 原请求
+		std::vector<char> reply(8 + frame.length);
+		auto current_time = getMicroTimestamp();
+		std::memcpy(reply.data(), &current_time, 8);
+		std::memcpy(reply.data() + 8, frame.body, frame.length);
+		{
+			ScopedTimer timer("sendData");
+			codec_.send(conn, 3, reply.data(), reply.size());
 		}
-		
-		return decoded_timestamp;
 	}
-private:
-	constexpr static size_t kHeaderLen = 5;
-};
 
-class CubeServer: public TcpSpi {
-public:
-	void onAccepted(std::shared_ptr<Connection> conn) override {
-        spdlog::info("onAccepted called with fd: {}", conn->fdWrapper().fd());
-        auto id = conn->registerTimer(10000, [conn] {
-            // heartbeat
-            spdlog::info("heartbeat");
-        }, true);
-        timerId_ = id;
-        spdlog::info("Connection accepted with timer ID: {}", id);
-	}
+	TcpSpi* spi() { return &codec_; }
 
-	void onDisconnected(std::shared_ptr<Connection> conn, int reason, const char* reason_str) override {
-        bool res = conn->cancelTimer(timerId_);
-        spdlog::info("Connection disconnected with timer ID: {}, res: {}", timerId_, res);
-	}
-
-	void onMessage(std::shared_ptr<Connection> conn, const char* data, size_t len) override {
-		// write connection's private buffer
-        buffer_.write(data, len);
-		{
-            ScopedTimer timer("onMessageLoop");
-            for (;;) {
-                auto [messageBodyLen, valid] = coder_.decode(buffer_);
-                if (!valid) {
-                    break; // 退出循环，等待下次消息
-                }
-                auto sendLen = messageBodyLen + 5 + 8;
-                std::vector<char> header(13);
-                coder_.encodeHeaderWithTimeStamp(header, messageBodyLen);
-                {
-                    ScopedTimer timer("sendData");
-                    conn->send(header.data(), header.size());
-                    conn->send(buffer_.data(), messageBodyLen);
-                }
-                
-                buffer_.advance(messageBodyLen);
-            }
-        }
-	}
 private:
-	Coder coder_;
-	SimpleBuffer buffer_;
-    uint64_t timerId_;
+	Codec codec_{this};
 };
 
 
@@ -213,13 +123,16 @@ public:
 		printf("[+] connection closed: %s\n", reason_str);
 	}
 
-	void onMessage(std::shared_ptr<Connection> conn, const char* data, size_t len) override {
+	void onMessage(std::shared_ptr<Connection> conn, SimpleBuffer& buffer) override {
+		const char* data = buffer.data();
+		size_t len = buffer.size();
 		printf("[+] received message: %.*s\n", (int)len, data);
 		std::vector<char> vec;
 		for (int i = 0; i < 10; ++i) {
 			vec.insert(vec.end(), data, data + len);
 		}
 		conn->send(vec.data(), vec.size()); // echo back
+		buffer.advance(len);
 	}
 };
 
@@ -228,7 +141,8 @@ void reactor_run()
 	TcpApi api;
 	api.bindAddress("127.0.0.1", DEFAULT_PORT);
 	CubeServer c;
-	api.registerSpi(&c);
+	api.registerSpi(c.spi());
+	api.setIdleTimeout(30 * 1000); // 30 秒没有请求的连接由 reactor 断开
 	api.run();
 }
 
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <functional>
+
+// 监听套接字，accept4 直接得到非阻塞、CLOEXEC 的连接
+// 监听 fd 以 EPOLLET 注册，每次可读都要 accept 到 EAGAIN，否则积压的连接不会再通知
+class Acceptor {
+public:
+    using NewConnectionCallback = std::function<void(int fd)>;
+
+    // reusePort 为 true 时设置 SO_REUSEPORT，同一端口可由多个 Acceptor 监听，内核按四元组分配连接
+    explicit Acceptor(bool reusePort = false);
+    ~Acceptor();
+
+    Acceptor(const Acceptor&) = delete;
+    Acceptor& operator=(const Acceptor&) = delete;
+
+    void bindAddress(const char* address, int port);
+
+    // 取完所有已完成握手的连接，返回本次接受的个数
+    int acceptAll(const NewConnectionCallback& callback);
+
+    int fd() const { return listenFd_; }
+
+private:
+    int listenFd_;
+    int idleFd_; // 预留 fd，文件描述符耗尽时用它接受并立即关闭连接，清空积压
+};
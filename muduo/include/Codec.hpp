@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "TcpSpi.hpp"
+
+// 一个完整帧，body 指向连接接收缓冲中已原地解码的帧体，只在 onFrame 期间有效
+struct Frame {
+    uint8_t type;
+    char* body;
+    uint32_t length;
+};
+
+class FrameSpi {
+public:
+    virtual void onAccepted(std::shared_ptr<Connection> conn) = 0;
+    virtual void onDisconnected(std::shared_ptr<Connection> conn, int r, const char* reason) = 0;
+    virtual void onFrame(std::shared_ptr<Connection> conn, Frame& frame) = 0;
+};
+
+// 帧格式：1 字节类型 + 4 字节长度（主机序）+ 帧体，帧体逐字节交替加 0x4A/0x51
+// 作为 TcpSpi 注册到 TcpApi，在连接的接收缓冲上切帧、解码，
+// 只把完整帧交给 FrameSpi，半包留在缓冲中等下次数据
+class Codec : public TcpSpi {
+public:
+    static constexpr size_t kHeaderLen = 5;
+
+    // lengthIncludesHeader 为 true 时长度字段是整帧长度，否则只是帧体长度
+    explicit Codec(FrameSpi* spi, bool lengthIncludesHeader = true, uint32_t maxFrameLen = 16 * 1024 * 1024);
+
+    void onAccepted(std::shared_ptr<Connection> conn) override;
+    void onDisconnected(std::shared_ptr<Connection> conn, int r, const char* reason) override;
+    void onMessage(std::shared_ptr<Connection> conn, SimpleBuffer& buffer) override;
+
+    // 编码一帧后一次性发送，线程安全
+    void send(const std::shared_ptr<Connection>& conn, uint8_t type, const char* data, uint32_t len);
+
+    // output 至少 kHeaderLen + len 字节，返回整帧长度
+    size_t encode(uint8_t type, const char* data, uint32_t len, char* output) const;
+
+    // 原地加/减偏移，data[0] 为帧体第一个字节
+    static void encodeBody(char* data, size_t len);
+    static void decodeBody(char* data, size_t len);
+
+private:
+    FrameSpi* spi_;
+    bool lengthIncludesHeader_;
+    uint32_t maxFrameLen_;
+};
@@ -3,32 +3,49 @@
 #include "Epoll.hpp"
 #include <memory>
 #include <atomic>
+#include <string>
 #include "SimpleBuffer.hpp"
+#include "MpscQueue.hpp"
 class SubReactor;
 
 class Connection {
 public:
     Connection(FdWrapper fdWrapper, SubReactor* subReactor);
-    // async send thread-safe
+    // 线程安全。SubReactor 线程内直接写 socket，其他线程无锁入队后由 SubReactor 发送
     void send(const char* data, size_t len);
 
     void close(bool force = false);
     bool isClosed() const {
         return closed_;
     }
+    // 已调用 close()，可能还在等待发送缓冲写完；此后读端已 shutdown，不再读取
+    bool isClosing() const {
+        return tryClose_;
+    }
+    // 只在 SubReactor 线程中调用：取出其他线程入队的数据并尽量写出
     void sendBufferedData(); 
     void checkNeedClose();
     FdWrapper& fdWrapper() { return fdWrapper_; }
+    // 接收缓冲，只在所属 SubReactor 线程中访问
+    SimpleBuffer& inputBuffer() { return inputBuffer_; }
     int64_t registerTimer(int64_t interval_ms, std::function<void()> callback, bool recurring = false);
     bool cancelTimer(int64_t timer_id);
 
 private:
+    void sendInLoop(const char* data, size_t len);
+    void drainSendQueue();
+    // 写不完时关注 EPOLLOUT，写完后取消
+    void setWriting(bool on);
+
     std::atomic<bool> tryClose_ {false};
     bool closed_ = false;
     FdWrapper fdWrapper_; // 文件描述符包装器
     SubReactor* subReactor_;
-    std::mutex sendMutex_; // 保护sendBuffer_
-    SimpleBuffer sendBuffer_;
-    // std::vector<char> recvBuffer_;
+    // 其他线程的待发数据，短消息落在 std::string 的 SSO 内不再额外分配
+    MpscQueue<std::string> sendQueue_;
+    // 已登记到 SubReactor 的待写列表，一轮循环内同一连接只登记一次
+    std::atomic<bool> writePending_ {false};
+    SimpleBuffer sendBuffer_; // 未写出的数据，只在 SubReactor 线程中访问
+    SimpleBuffer inputBuffer_; // 未消费完的接收数据，跨多次读事件保留
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Reactor.hpp"
+#include "Acceptor.hpp"
 #include <arpa/inet.h>
 
 class SubReactor;
@@ -12,13 +13,18 @@ public:
     virtual void setSpi(TcpSpi *spi) override;
     virtual void run() override;
 
-    void bindAddress(const char* address, int port);
+    // reusePort 为 true 时每个 SubReactor 各自用 SO_REUSEPORT 监听同一端口并直接 accept，
+    // 新连接不再经过 MainReactor 转交
+    void bindAddress(const char* address, int port, bool reusePort = false);
+
+    // 所有 SubReactor 上超过 timeout_ms 没有收到数据的连接被断开，<= 0 关闭
+    void setIdleTimeout(int64_t timeout_ms);
 
     virtual ~MainReactor();
 
 protected:
     void handleEvent(FdWrapper &fdw) override {
-        if (fdw.fd() == listen_fd_) {
+        if (acceptor_ && fdw.fd() == acceptor_->fd()) {
             handleAccept();
         }
     }
@@ -26,7 +32,7 @@ protected:
     void handleAccept();
 
 private:
-    int listen_fd_;
+    std::unique_ptr<Acceptor> acceptor_; // SO_REUSEPORT 模式下为空
     std::vector<std::shared_ptr<SubReactor>> sub_reactors_;
-    std::atomic<int> next_sub_idx_;
+    std::atomic<int> next_sub_idx_{0};
 };
\ No newline at end of file
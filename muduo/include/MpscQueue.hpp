@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// 多生产者单消费者无锁队列（Vyukov 链表），push 任意线程调用，
+// pop/empty 只能由唯一的消费者线程调用
+// push 是一次 exchange 加一次 store，不会因其他生产者阻塞或重试
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head_(new Node), tail_(head_.load(std::memory_order_relaxed)) {}
+
+    ~MpscQueue() {
+        T value;
+        while (pop(value)) {
+        }
+        delete tail_;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        // 在这两步之间消费者看不到 node，之后的 pop 会补上
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool pop(T& value) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        // next 成为新的哨兵节点
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+
+    bool empty() const {
+        return tail_->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next {nullptr};
+        T value;
+    };
+
+    alignas(64) std::atomic<Node*> head_; // 生产者端，避免与消费者伪共享
+    alignas(64) Node* tail_;              // 消费者端
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// 帧体的 0x4A/0x51 交替偏移：偶数下标加 0x4A，奇数下标加 0x51，解码相减
+// 按 CPU 支持情况在 AVX-512BW / AVX2 / SSE2 / 标量实现中选一个，进程启动时确定
+class OffsetCoder {
+public:
+    using Transform = void (*)(const char* in, char* out, size_t len);
+
+    struct Kernel {
+        const char* name;
+        Transform encode;
+        Transform decode;
+    };
+
+    // in 与 out 可以是同一块内存
+    static void encode(const char* in, char* out, size_t len) { active().encode(in, out, len); }
+    static void decode(const char* in, char* out, size_t len) { active().decode(in, out, len); }
+
+    // 原地变换，直接作用在收发缓冲上
+    static void encode(char* data, size_t len) { active().encode(data, data, len); }
+    static void decode(char* data, size_t len) { active().decode(data, data, len); }
+
+    // 当前使用的实现
+    static const Kernel& active();
+    // 本机可用的全部实现，标量在前，供测试和基准对比
+    static std::vector<Kernel> supported();
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <cerrno>
+#include <sys/uio.h>
 #include "Utils.hpp"
 
 
@@ -38,9 +40,39 @@ public:
     }
 
     const char* data() const { return buffer_ + readPos_; }
+    char* data() { return buffer_ + readPos_; }
     size_t size() const { return writePos_ - readPos_; }
     bool noData() const { return writePos_ == readPos_; }
 
+    // 尾部可写区域，直接写入后用 hasWritten 提交
+    char* beginWrite() { return buffer_ + writePos_; }
+    size_t writableBytes() const { return bufferSize_ - writePos_; }
+    void hasWritten(size_t len) { writePos_ += len; }
+
+    // 一次 readv 读入尾部空闲区，放不下的部分先落到栈上再追加
+    // 返回值同 read，出错时 errno 存入 savedErrno
+    ssize_t readFd(int fd, int* savedErrno) {
+        char extraBuffer[65536];
+        struct iovec vec[2];
+        const size_t writable = writableBytes();
+        vec[0].iov_base = beginWrite();
+        vec[0].iov_len = writable;
+        vec[1].iov_base = extraBuffer;
+        vec[1].iov_len = sizeof(extraBuffer);
+        // 尾部空间已经够大时不再用栈缓冲
+        const int iovcnt = writable < sizeof(extraBuffer) ? 2 : 1;
+        const ssize_t n = ::readv(fd, vec, iovcnt);
+        if (n < 0) {
+            *savedErrno = errno;
+        } else if (static_cast<size_t>(n) <= writable) {
+            hasWritten(n);
+        } else {
+            writePos_ = bufferSize_;
+            write(extraBuffer, n - writable);
+        }
+        return n;
+    }
+
 private:
     char* buffer_;
     size_t bufferSize_ = 0;
@@ -7,7 +7,8 @@
 #include "Connection.hpp"
 #include <functional>
 #include <chrono>
-#include <set>
+#include "TimingWheel.hpp"
+#include "Acceptor.hpp"
 #include <Utils.hpp>
 
 class SubReactor: public Reactor, public std::enable_shared_from_this<SubReactor> {
@@ -21,27 +22,48 @@ public:
     void start();
     void stop(); // 停止子反应器
     void join(); // 等待子线程结束
-     // 将新连接加入队列
-    void enqueueNewConnection(int fd);
 
+    using Functor = std::function<void()>;
+
+    // 在 SubReactor 线程中执行：本线程直接调用，其他线程入队
+    void runInLoop(Functor task);
+    // 总是入队，本轮事件处理完后执行；循环醒着时不再写 eventfd
+    void queueInLoop(Functor task);
+    bool isInLoopThread() const { return std::this_thread::get_id() == loopThread_; }
+
+    // SO_REUSEPORT 模式：本线程自己监听并 accept，须在 start 之前调用
+    void bindAddress(const char* address, int port);
+
+    // 将新连接交给 SubReactor 线程
+    void enqueueNewConnection(int fd);
+    // 登记待写连接
     void enqueueSend(int fd);
+    void updateConnection(FdWrapper& fdw);
     
     void disableReadEventAndShutdown(FdWrapper& fdw);
     void removeConnection(FdWrapper& fdw);
 
+    // 本线程注册直接加入时间轮，返回时间轮句柄；其他线程注册转到 SubReactor 线程执行
     int64_t registerTimer(int64_t interval_ms, std::function<void()> callback, bool recurring = false);
+    // 其他线程调用时只是提交取消，返回 true
     bool cancelTimer(int64_t timer_id);
     void handleTimerEvents();
 
-    void updateNextTimer();
-    void disableTimer();
-    
-    void handlePipe();
+    // 只在最近的到期时刻提前时才重设 timerfd
+    void rearmTimer();
 
-    void processSendQueue(); // 处理发送队列中的事件
+    // 超过 timeout_ms 没有收到数据的连接被断开，<= 0 关闭回收，线程安全
+    void setIdleTimeout(int64_t timeout_ms);
+    // 扫描一轮，回收空闲连接
+    void sweepIdleConnections();
+    
+    void run() override;
+    void handleWakeup();
+    void wakeup();
+    void doPendingTasks();
 
     // 处理新连接
-    void processNewConnections();
+    void addConnection(int fd);
 
     void handleEvent(FdWrapper& event) override;
 
@@ -51,31 +73,29 @@ public:
 
 
 private:
-    int pipeFds_[2]; // pipe 用于通知新连接
+    int wakeupFd_ = -1; // eventfd，跨线程投递任务时唤醒 epoll
+    // 为 true 时循环醒着或已被唤醒，会在睡眠前执行队列中的任务，投递方不必再写 eventfd
+    std::atomic<bool> wakeupPending_ {false};
+    MpscQueue<Functor> pendingTasks_;
     std::thread thread_;
+    std::thread::id loopThread_;
     ConnectionMap connectionMap_; // 管理连接的映射
-    std::vector<int> newConnections_;
-    std::vector<int> sendQueue_;
-    std::mutex connMutex_;
-    std::mutex sendMutex_;
-    Spinlock connSpinlock_;
-    Spinlock sendSpinlock_;
+    std::unique_ptr<Acceptor> acceptor_; // 只在 SO_REUSEPORT 模式下存在
+
+    static uint64_t nowTick(); // CLOCK_MONOTONIC 毫秒数，即时间轮的刻度
 
     int timer_fd_ = -1; // timerfd 文件描述符
-    std::atomic<int64_t> next_timer_id_{0}; // 定时器ID生成器
-
-    struct TimerInfo {
-        int64_t id;
-        int64_t interval_ms;
-        std::function<void()> callback;
-        bool recurring;
-        std::chrono::steady_clock::time_point expiration;
-        
-        bool operator<(const TimerInfo& other) const {
-            return expiration < other.expiration;
-        }
-    };
-
-    std::set<TimerInfo> timers_;
-    std::mutex timers_mutex_;
+    TimingWheel timerWheel_;
+    uint64_t armedTick_ = TimingWheel::kNoTimer; // timerfd 已设定的绝对刻度
+    // 其他线程注册的定时器编号，高 32 位为 0，不会与时间轮句柄冲突
+    std::atomic<uint32_t> next_timer_id_{0};
+    std::unordered_map<int64_t, int64_t> remoteTimers_; // 编号 -> 时间轮句柄
+
+    // 空闲回收不给每个连接建定时器：按 fd 下标记录最近收到数据时的扫描轮次，
+    // 一个周期定时器每 timeout / kIdleSweeps 扫描一轮，连接空闲 timeout ~ 1.25 timeout 后断开
+    static constexpr uint32_t kIdleSweeps = 4;
+    std::vector<uint32_t> lastActive_; // 0 表示该 fd 上没有连接
+    uint32_t idleEpoch_ = 1;           // 当前扫描轮次
+    int64_t idleTimer_ = -1;
+    std::vector<int> idleFds_;         // 本轮待回收的 fd
 };
\ No newline at end of file
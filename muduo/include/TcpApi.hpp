@@ -11,14 +11,20 @@ class TcpApi {
 public:
     TcpApi() {
     }
-    void bindAddress(const char* ip, int port) {
-        mainReactor_.bindAddress(ip, port);
+    // reusePort 为 true 时每个 SubReactor 各自监听、各自 accept
+    void bindAddress(const char* ip, int port, bool reusePort = false) {
+        mainReactor_.bindAddress(ip, port, reusePort);
     }
 
     void registerSpi(TcpSpi* spi) {
         mainReactor_.setSpi(spi);
     }
 
+    // 空闲超时，断开时回调 onDisconnected(conn, 4, "idle timeout")
+    void setIdleTimeout(int64_t timeout_ms) {
+        mainReactor_.setIdleTimeout(timeout_ms);
+    }
+
     void run() {
         mainReactor_.run();
     }
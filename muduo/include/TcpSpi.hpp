@@ -6,5 +6,7 @@ class TcpSpi {
 public:
     virtual void onAccepted(std::shared_ptr<Connection> conn) = 0;
     virtual void onDisconnected(std::shared_ptr<Connection> conn, int r, const char* reason) = 0;
-    virtual void onMessage(std::shared_ptr<Connection> conn, const char* data, size_t len) = 0;
+    // buffer 为连接自带的接收缓冲，按完整帧原地解析并 advance 已消费的字节，
+    // 不完整的帧留在 buffer 中，下次数据到达时继续
+    virtual void onMessage(std::shared_ptr<Connection> conn, SimpleBuffer& buffer) = 0;
 };
\ No newline at end of file
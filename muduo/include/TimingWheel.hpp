@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 分层时间轮，一个刻度 1ms，6 层每层 64 个槽，覆盖 2^36ms（约 2 年）
+// 第 0 层的槽对应具体的某一毫秒，高层的槽在低层转完一圈时降级到低层
+// 定时器节点放在数组里按下标串成双向链表，句柄 = 代数 << 32 | 下标，
+// 插入、取消都是 O(1)，节点复用后旧句柄因代数不符而失效
+// 非线程安全，只在所属 SubReactor 线程中使用
+class TimingWheel {
+public:
+    using Callback = std::function<void()>;
+
+    static constexpr uint64_t kNoTimer = UINT64_MAX;
+
+    explicit TimingWheel(uint64_t now = 0);
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // now + delay 时刻到期，recurring 为 true 时到期后再按 delay 重新计时
+    int64_t add(uint64_t now, uint64_t delay, Callback callback, bool recurring = false);
+
+    // 回调执行中取消自己也可以，只是不再重新计时
+    bool cancel(int64_t handle);
+
+    // 推进到 now 并执行所有到期回调
+    void advance(uint64_t now);
+
+    // 下一个需要处理的刻度：最近的到期时刻或高层槽降级的时刻，没有定时器时为 kNoTimer
+    uint64_t nextTick() const;
+
+    size_t size() const { return size_; }
+
+private:
+    static constexpr int kLevels = 6;
+    static constexpr int kSlotBits = 6;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    enum class State : uint8_t { Free, Linked, Expired, Firing, Cancelled };
+
+    struct Node {
+        uint64_t expire = 0;
+        uint64_t interval = 0;
+        Callback callback;
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 1;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool recurring = false;
+        State state = State::Free;
+    };
+
+    uint32_t allocate();
+    void release(uint32_t index);
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(int level);
+    void expire();
+    void step();
+
+    uint64_t current_; // 已处理到的刻度
+    size_t size_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> freeList_;
+    std::vector<uint32_t> expired_; // 当前刻度到期、等待执行的节点
+    uint32_t heads_[kLevels][kSlots];
+    uint64_t occupied_[kLevels] = {}; // 每层非空槽的位图
+};
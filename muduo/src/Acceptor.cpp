@@ -0,0 +1,86 @@
+#include "Acceptor.hpp"
+#include "spdlog/spdlog.h"
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+Acceptor::Acceptor(bool reusePort) {
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        spdlog::error("socket listen fd failed");
+        exit(EXIT_FAILURE);
+    }
+
+    int optval = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    if (reusePort && setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+        spdlog::error("set SO_REUSEPORT failed: {}", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    idleFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+Acceptor::~Acceptor() {
+    close(listenFd_);
+    if (idleFd_ >= 0) {
+        close(idleFd_);
+    }
+}
+
+void Acceptor::bindAddress(const char* address, int port) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr(address);
+
+    if (bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        spdlog::error("bind failed {}:{}", address, port);
+        exit(EXIT_FAILURE);
+    }
+
+    if (listen(listenFd_, SOMAXCONN) < 0) {
+        spdlog::error("listen failed {}:{}", address, port);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int Acceptor::acceptAll(const NewConnectionCallback& callback) {
+    int count = 0;
+    while (true) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            ++count;
+            callback(fd);
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        // 对端在握手完成后已经断开，或被信号打断，继续取下一个
+        if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+            continue;
+        }
+        if ((errno == EMFILE || errno == ENFILE) && idleFd_ >= 0) {
+            // fd 耗尽：腾出预留的 fd 接受一个连接并关闭，直到积压清空。
+            // accept4 先占 fd 再看积压，积压为空时同样报 EMFILE，只能靠 accept 的 EAGAIN 判断
+            spdlog::error("accept failed: {}, dropping connection", strerror(errno));
+            close(idleFd_);
+            int dropped = accept(listenFd_, nullptr, nullptr);
+            if (dropped >= 0) {
+                close(dropped);
+            }
+            idleFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+            if (dropped < 0 || idleFd_ < 0) {
+                break;
+            }
+            continue;
+        }
+        spdlog::error("accept failed: {}", strerror(errno));
+        break;
+    }
+    return count;
+}
@@ -0,0 +1,73 @@
+#include "Codec.hpp"
+#include "OffsetCoder.hpp"
+#include "spdlog/spdlog.h"
+#include <cstring>
+#include <vector>
+
+Codec::Codec(FrameSpi* spi, bool lengthIncludesHeader, uint32_t maxFrameLen)
+    : spi_(spi), lengthIncludesHeader_(lengthIncludesHeader), maxFrameLen_(maxFrameLen) {
+}
+
+void Codec::onAccepted(std::shared_ptr<Connection> conn) {
+    spi_->onAccepted(conn);
+}
+
+void Codec::onDisconnected(std::shared_ptr<Connection> conn, int r, const char* reason) {
+    spi_->onDisconnected(conn, r, reason);
+}
+
+void Codec::onMessage(std::shared_ptr<Connection> conn, SimpleBuffer& buffer) {
+    while (buffer.size() >= kHeaderLen) {
+        char* data = buffer.data();
+        uint32_t lengthField;
+        std::memcpy(&lengthField, data + 1, 4);
+
+        // 长度字段换算成帧体长度，不合法直接断开
+        bool tooShort = lengthIncludesHeader_ && lengthField < kHeaderLen;
+        uint32_t bodyLen = lengthIncludesHeader_ ? lengthField - kHeaderLen : lengthField;
+        if (tooShort || bodyLen > maxFrameLen_) {
+            spdlog::error("Invalid frame length {} on fd={}", lengthField, conn->fdWrapper().fd());
+            spi_->onDisconnected(conn, 3, "invalid frame length");
+            conn->close(true);
+            return;
+        }
+
+        size_t frameLen = kHeaderLen + bodyLen;
+        if (buffer.size() < frameLen) {
+            break; // 半包，等待后续数据
+        }
+
+        Frame frame{static_cast<uint8_t>(data[0]), data + kHeaderLen, bodyLen};
+        decodeBody(frame.body, frame.length);
+        spi_->onFrame(conn, frame);
+        // 回调中关闭连接后不再交付后续帧，优雅关闭时发送缓冲可能还没写完
+        if (conn->isClosed() || conn->isClosing()) {
+            return;
+        }
+        buffer.advance(frameLen);
+    }
+}
+
+void Codec::send(const std::shared_ptr<Connection>& conn, uint8_t type, const char* data, uint32_t len) {
+    // 每个线程一块发送缓冲，避免逐帧分配
+    thread_local std::vector<char> frame;
+    frame.resize(kHeaderLen + len);
+    size_t n = encode(type, data, len, frame.data());
+    conn->send(frame.data(), n);
+}
+
+size_t Codec::encode(uint8_t type, const char* data, uint32_t len, char* output) const {
+    uint32_t lengthField = lengthIncludesHeader_ ? len + kHeaderLen : len;
+    output[0] = static_cast<char>(type);
+    std::memcpy(output + 1, &lengthField, 4);
+    OffsetCoder::encode(data, output + kHeaderLen, len);
+    return kHeaderLen + len;
+}
+
+void Codec::encodeBody(char* data, size_t len) {
+    OffsetCoder::encode(data, len);
+}
+
+void Codec::decodeBody(char* data, size_t len) {
+    OffsetCoder::decode(data, len);
+}
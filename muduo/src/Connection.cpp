@@ -2,6 +2,7 @@
 #include "spdlog/spdlog.h"
 #include "SubReactor.hpp"
 #include <unistd.h>
+#include <cstring>
 
 Connection::Connection(FdWrapper fdWrapper, SubReactor* subReactor)
     : fdWrapper_(fdWrapper), subReactor_(subReactor)  {
@@ -11,48 +12,82 @@ Connection::Connection(FdWrapper fdWrapper, SubReactor* subReactor)
 }
 
 void Connection::send(const char* data, size_t len) {
-    ScopedTimer timer("ConnectionSend");
     if (tryClose_) {
         return;
     }
-    std::lock_guard<std::mutex> lock(sendMutex_);
-    // buffer into sendBuffer_
-    sendBuffer_.write(data, len);
-    subReactor_->enqueueSend(fdWrapper_.fd());
+    if (subReactor_->isInLoopThread()) {
+        sendInLoop(data, len);
+        return;
+    }
+    sendQueue_.push(std::string(data, len));
+    // 已在待写列表中则由那一次统一发送
+    if (!writePending_.exchange(true, std::memory_order_acq_rel)) {
+        subReactor_->enqueueSend(fdWrapper_.fd());
+    }
 }
 
-
-void Connection::sendBufferedData() {
-    std::lock_guard<std::mutex> lock(sendMutex_);
-        ssize_t n;
+void Connection::sendInLoop(const char* data, size_t len) {
+    // 先并入其他线程更早入队的数据，保证顺序
+    drainSendQueue();
+    ssize_t n = 0;
     if (sendBuffer_.noData()) {
-        spdlog::info("No data to send for fd: {}", fdWrapper_.fd());
-        return;
+        n = ::write(fdWrapper_.fd(), data, len);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                spdlog::error("write error on fd={}: {}", fdWrapper_.fd(), strerror(errno));
+                return;
+            }
+            n = 0;
+        }
+    }
+    if (static_cast<size_t>(n) < len) {
+        sendBuffer_.write(data + n, len - n);
+        setWriting(true);
     }
+}
 
-    do {
-        auto writeChunkSize = std::min(sendBuffer_.size(), static_cast<size_t>(1024 * 8)); // 每次写入4096字节
-        n = write(fdWrapper_.fd(), sendBuffer_.data(), writeChunkSize);
-        
+void Connection::drainSendQueue() {
+    std::string chunk;
+    while (sendQueue_.pop(chunk)) {
+        sendBuffer_.write(chunk.data(), chunk.size());
+    }
+}
+
+void Connection::sendBufferedData() {
+    // 先清标记再取数据，之后入队的数据会重新登记
+    writePending_.exchange(false, std::memory_order_acq_rel);
+    drainSendQueue();
+
+    while (!sendBuffer_.noData()) {
+        ssize_t n = ::write(fdWrapper_.fd(), sendBuffer_.data(), sendBuffer_.size());
         if (n < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                // spdlog::debug("Write would block on fd={}", conn->fdWrapper().fd());
-                break; // 非阻塞模式下，退出循环
-            } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                spdlog::error("write error on fd={}: {}", fdWrapper_.fd(), strerror(errno));
                 return;
             }
-        } else if (n == 0) {
-            break; // 连接可能已经关闭
-        } else {
-            sendBuffer_.advance(n); // 更新发送缓冲区
+            break; // 内核缓冲已满，等 EPOLLOUT
         }
-    } while (n > 0 && sendBuffer_.size() > 0);
-    
+        sendBuffer_.advance(n); // 更新发送缓冲区
+    }
+
+    setWriting(!sendBuffer_.noData());
+    if (sendBuffer_.noData()) {
+        checkNeedClose();
+    }
+}
+
+void Connection::setWriting(bool on) {
+    uint32_t events = on ? (fdWrapper_.events() | EPOLLOUT) : (fdWrapper_.events() & ~EPOLLOUT);
+    if (static_cast<uint32_t>(fdWrapper_.events()) == events) {
+        return;
+    }
+    fdWrapper_.setEvents(events);
+    subReactor_->updateConnection(fdWrapper_);
 }
 
 void Connection::close(bool force) {
     tryClose_ = true;
-    if (!force && sendBuffer_.size()) {
+    if (!force && (!sendBuffer_.noData() || !sendQueue_.empty())) {
         spdlog::info("Pending connection close with fd: {} force: {}, sendBuffer size: {}", fdWrapper_.fd(), force, sendBuffer_.size());
         subReactor_->disableReadEventAndShutdown(fdWrapper_);
         return;
@@ -62,9 +97,9 @@ void Connection::close(bool force) {
 }
 
 void Connection::checkNeedClose() {
-    if (tryClose_ && sendBuffer_.noData()) {
-        subReactor_->removeConnection(fdWrapper_);
+    if (tryClose_ && !closed_ && sendBuffer_.noData()) {
         closed_ = true;
+        subReactor_->removeConnection(fdWrapper_);
     }
 }
 int64_t Connection::registerTimer(int64_t interval_ms, std::function<void()> callback, bool recurring) {
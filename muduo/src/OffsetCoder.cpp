@@ -0,0 +1,182 @@
+#include "OffsetCoder.hpp"
+#include <cstdint>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr uint8_t kEvenOffset = 0x4A;
+constexpr uint8_t kOddOffset = 0x51;
+// 每 2 字节一个周期，小端下 16 位常量即 {0x4A, 0x51}
+constexpr short kPair = static_cast<short>(kOddOffset << 8 | kEvenOffset);
+
+// 向量部分处理完的位置总是偶数，尾部从偶数下标开始
+void scalarTail(const char* in, char* out, size_t i, size_t len, bool decode) {
+    for (; i < len; ++i) {
+        uint8_t offset = i % 2 ? kOddOffset : kEvenOffset;
+        out[i] = static_cast<char>(decode ? in[i] - offset : in[i] + offset);
+    }
+}
+
+void encodeScalar(const char* in, char* out, size_t len) {
+    size_t i = 0;
+    for (; i + 1 < len; i += 2) {
+        out[i] = static_cast<char>(in[i] + kEvenOffset);
+        out[i + 1] = static_cast<char>(in[i + 1] + kOddOffset);
+    }
+    scalarTail(in, out, i, len, false);
+}
+
+void decodeScalar(const char* in, char* out, size_t len) {
+    size_t i = 0;
+    for (; i + 1 < len; i += 2) {
+        out[i] = static_cast<char>(in[i] - kEvenOffset);
+        out[i + 1] = static_cast<char>(in[i + 1] - kOddOffset);
+    }
+    scalarTail(in, out, i, len, true);
+}
+
+#if defined(__x86_64__)
+void encodeSse2(const char* in, char* out, size_t len) {
+    const __m128i offsets = _mm_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(v, offsets));
+    }
+    scalarTail(in, out, i, len, false);
+}
+
+void decodeSse2(const char* in, char* out, size_t len) {
+    const __m128i offsets = _mm_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi8(v, offsets));
+    }
+    scalarTail(in, out, i, len, true);
+}
+
+// 每轮两个 32 字节向量，剩余不足 32 字节的部分仍在本函数内用 VEX 编码的 128 位指令处理。
+// 不能跳到 encodeSse2：传统 SSE 指令遇到 YMM 高半部分非零会付出状态切换的代价，
+// 进入标量尾部前也先清零高半部分
+__attribute__((target("avx2")))
+void encodeAvx2(const char* in, char* out, size_t len) {
+    const __m256i offsets = _mm256_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi8(a, offsets));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_add_epi8(b, offsets));
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi8(a, offsets));
+    }
+    if (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(v, _mm256_castsi256_si128(offsets)));
+        i += 16;
+    }
+    _mm256_zeroupper();
+    scalarTail(in, out, i, len, false);
+}
+
+__attribute__((target("avx2")))
+void decodeAvx2(const char* in, char* out, size_t len) {
+    const __m256i offsets = _mm256_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi8(a, offsets));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 32), _mm256_sub_epi8(b, offsets));
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi8(a, offsets));
+    }
+    if (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi8(v, _mm256_castsi256_si128(offsets)));
+        i += 16;
+    }
+    _mm256_zeroupper();
+    scalarTail(in, out, i, len, true);
+}
+
+// 尾部用掩码读写，不再回落到标量
+__attribute__((target("avx512f,avx512bw,bmi2")))
+void encodeAvx512(const char* in, char* out, size_t len) {
+    const __m512i offsets = _mm512_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i, _mm512_add_epi8(v, offsets));
+    }
+    if (i < len) {
+        __mmask64 mask = _bzhi_u64(~0ULL, static_cast<unsigned>(len - i));
+        __m512i v = _mm512_maskz_loadu_epi8(mask, in + i);
+        _mm512_mask_storeu_epi8(out + i, mask, _mm512_add_epi8(v, offsets));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw,bmi2")))
+void decodeAvx512(const char* in, char* out, size_t len) {
+    const __m512i offsets = _mm512_set1_epi16(kPair);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i, _mm512_sub_epi8(v, offsets));
+    }
+    if (i < len) {
+        __mmask64 mask = _bzhi_u64(~0ULL, static_cast<unsigned>(len - i));
+        __m512i v = _mm512_maskz_loadu_epi8(mask, in + i);
+        _mm512_mask_storeu_epi8(out + i, mask, _mm512_sub_epi8(v, offsets));
+    }
+}
+
+#endif
+
+const OffsetCoder::Kernel kScalar {"scalar", encodeScalar, decodeScalar};
+#if defined(__x86_64__)
+const OffsetCoder::Kernel kSse2 {"sse2", encodeSse2, decodeSse2};
+const OffsetCoder::Kernel kAvx2 {"avx2", encodeAvx2, decodeAvx2};
+const OffsetCoder::Kernel kAvx512 {"avx512bw", encodeAvx512, decodeAvx512};
+
+bool hasAvx512() {
+    __builtin_cpu_init(); // 可能在其他静态初始化中被调用
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+        && __builtin_cpu_supports("bmi2");
+}
+#endif
+
+} // namespace
+
+// 非 x86-64 只有标量实现
+const OffsetCoder::Kernel& OffsetCoder::active() {
+#if defined(__x86_64__)
+    static const Kernel& kernel = hasAvx512() ? kAvx512
+        : __builtin_cpu_supports("avx2") ? kAvx2
+        : kSse2;
+    return kernel;
+#else
+    return kScalar;
+#endif
+}
+
+std::vector<OffsetCoder::Kernel> OffsetCoder::supported() {
+    std::vector<Kernel> kernels {kScalar};
+#if defined(__x86_64__)
+    kernels.push_back(kSse2);
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(kAvx2);
+    }
+    if (hasAvx512()) {
+        kernels.push_back(kAvx512);
+    }
+#endif
+    return kernels;
+}
@@ -1,22 +1,19 @@
 #include "SubReactor.hpp"
 #include "spdlog/spdlog.h"
 #include <sys/timerfd.h>
+#include <sys/eventfd.h>
 #include "Utils.hpp"
 #include <chrono>
+#include <algorithm>
 
-SubReactor::SubReactor() {
-    // 创建 pipe 用于通知新连接
-    if (pipe(pipeFds_) < 0) {
-        spdlog::error("pipe failed: {}", strerror(errno));
+SubReactor::SubReactor() : timerWheel_(nowTick()) {
+    // eventfd 用于跨线程唤醒
+    wakeupFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeupFd_ < 0) {
+        spdlog::error("eventfd failed: {}", strerror(errno));
         exit(EXIT_FAILURE);
     }
-
-    // 设置非阻塞
-    fcntl(pipeFds_[0], F_SETFL, O_NONBLOCK);
-    fcntl(pipeFds_[1], F_SETFL, O_NONBLOCK);
-
-    
-    epoll_.operateFd({pipeFds_[0], EPOLLIN | EPOLLET}, EPOLL_CTL_ADD);
+    addEpollFd({ wakeupFd_, EPOLLIN | EPOLLET });
 
     timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
     if (timer_fd_ == -1) {
@@ -29,8 +26,7 @@ SubReactor::SubReactor() {
 }
 
 SubReactor::~SubReactor() {
-    close(pipeFds_[0]);
-    close(pipeFds_[1]);
+    close(wakeupFd_);
     if (timer_fd_ != -1) {
         close(timer_fd_);
         timer_fd_ = -1;
@@ -40,6 +36,7 @@ SubReactor::~SubReactor() {
 void SubReactor::start() {
     thread_ = std::thread([thisPtr = shared_from_this()]() {
         spdlog::info("SubReactor thread started with reference count: {}", thisPtr.use_count());
+        thisPtr->loopThread_ = std::this_thread::get_id();
         thisPtr->isRunning_ = true;
         thisPtr->run();
     });
@@ -48,12 +45,7 @@ void SubReactor::start() {
 void SubReactor::stop() {
     spdlog::info("SubReactor stop");
     isRunning_ = false;
-    // 写入 pipe 通知
-    char ch = 1;
-    int n = write(pipeFds_[1], &ch, 1);
-    if (n < 0) {
-        spdlog::error("write pipe error: {}", strerror(errno));
-    }
+    wakeup();
 }
 
 void SubReactor::join() {
@@ -64,31 +56,74 @@ void SubReactor::join() {
     }
 }
 
-void SubReactor::enqueueNewConnection(int fd) {
-    connSpinlock_.lock();        
-    newConnections_.push_back(fd);
-    connSpinlock_.unlock();
-    // 写入 pipe 通知
-    char ch = 1;
-    int n = write(pipeFds_[1], &ch, 1);
-    if (n < 0) {
-        spdlog::error("write pipe error: {}", strerror(errno));
+void SubReactor::run() {
+    while (true) {
+        std::vector<FdWrapper> events;
+        epoll_.doEpoll(-1, events);
+        // 醒着期间投递的任务在本轮末尾执行，不必再唤醒
+        wakeupPending_.store(true, std::memory_order_release);
+        for (auto& event : events) {
+            handleEvent(event);
+        }
+        doPendingTasks();
+        if (!isRunning_) {
+            break;
+        }
+    }
+}
+
+void SubReactor::runInLoop(Functor task) {
+    if (isInLoopThread()) {
+        task();
+    } else {
+        queueInLoop(std::move(task));
     }
 }
 
+void SubReactor::queueInLoop(Functor task) {
+    pendingTasks_.push(std::move(task));
+    wakeup();
+}
+
+void SubReactor::doPendingTasks() {
+    // 先清标记再取任务，之后投递的任务会重新唤醒
+    wakeupPending_.exchange(false, std::memory_order_acq_rel);
+    Functor task;
+    while (pendingTasks_.pop(task)) {
+        task();
+    }
+}
+
+void SubReactor::bindAddress(const char* address, int port) {
+    acceptor_ = std::make_unique<Acceptor>(true);
+    acceptor_->bindAddress(address, port);
+    addEpollFd({ acceptor_->fd(), EPOLLIN | EPOLLET });
+}
+
+void SubReactor::enqueueNewConnection(int fd) {
+    queueInLoop([this, fd] { addConnection(fd); });
+}
+
 void SubReactor::enqueueSend(int fd) {
-    sendSpinlock_.lock();
-    sendQueue_.push_back(fd);
-    sendSpinlock_.unlock();
-    // spdlog::info("Enqueued send for fd={}", fd);
-    // 写入 pipe 通知
-    char ch = 1;
-    int n = write(pipeFds_[1], &ch, 1);
-    if (n < 0) {
-        spdlog::error("write pipe error: {}", strerror(errno));
+    queueInLoop([this, fd] { handleWrite(FdWrapper(fd, EPOLLOUT | EPOLLHUP | EPOLLET)); });
+}
+
+void SubReactor::wakeup() {
+    // 循环醒着或已被唤醒，睡眠前会执行队列中的任务
+    if (wakeupPending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t n = write(wakeupFd_, &one, sizeof(one));
+    if (n != sizeof(one)) {
+        spdlog::error("write eventfd error: {}", strerror(errno));
     }
 }
 
+void SubReactor::updateConnection(FdWrapper& fdw) {
+    modifyEpollFd(fdw);
+}
+
 
 void SubReactor::disableReadEventAndShutdown(FdWrapper& fdw) {
     spdlog::info("disable read event and shutdown on fd={}", fdw.fd());
@@ -103,61 +138,47 @@ void SubReactor::disableReadEventAndShutdown(FdWrapper& fdw) {
 
 void SubReactor::removeConnection(FdWrapper& fdw) {
     spdlog::info("remove connection on fd={}", fdw.fd());
-    connectionMap_.erase(fdw.fd());
+    // fdw 可能是连接自身的成员，函数返回前不能析构连接
+    ConnectionPtr conn;
+    auto it = connectionMap_.find(fdw.fd());
+    if (it != connectionMap_.end()) {
+        conn = std::move(it->second);
+        connectionMap_.erase(it);
+    }
+    if (static_cast<size_t>(fdw.fd()) < lastActive_.size()) {
+        lastActive_[fdw.fd()] = 0;
+    }
     deleteEpollFd(fdw);
     close(fdw.fd());
 }
 
-void SubReactor::handlePipe() {
-    char buffer[1024];
-    int n = read(pipeFds_[0], buffer, sizeof(buffer));
-    if (n < 0) {
-        spdlog::error("read pipe error: {}", strerror(errno));
+void SubReactor::handleWakeup() {
+    uint64_t count;
+    ssize_t n = read(wakeupFd_, &count, sizeof(count));
+    if (n < 0 && errno != EAGAIN) {
+        spdlog::error("read eventfd error: {}", strerror(errno));
     }
-    processNewConnections();
-    processSendQueue();
 }
 
-void SubReactor::processSendQueue() {
-    ScopedTimer timer(__func__);
-    std::vector<int> sendQueue;
-    {
-        sendSpinlock_.lock();
-        sendQueue = std::move(sendQueue_);
-        sendSpinlock_.unlock();
-    }
-
-    while (!sendQueue.empty()) {
-        auto fd = sendQueue.back();
-        sendQueue.pop_back();
-        handleWrite(FdWrapper(fd, EPOLLOUT | EPOLLHUP | EPOLLET));
-    }
-}
-
-void SubReactor::processNewConnections() {
-    ScopedTimer timer(__func__);
-    connSpinlock_.lock();
-    auto newConnections = std::move(newConnections_);
-    connSpinlock_.unlock();
-
-    while (!newConnections.empty()) {
-        auto fd = newConnections.back();
-        newConnections.pop_back();
-        
-        addEpollFd(FdWrapper(fd, EPOLLIN | EPOLLHUP | EPOLLET));
-        {
-            ScopedTimer timer("CreateConnection");
-            connectionMap_[fd] = std::make_shared<Connection>(FdWrapper(fd, EPOLLIN | EPOLLHUP | EPOLLET), this);
-            spi_->onAccepted(connectionMap_[fd]);
-        }
+void SubReactor::addConnection(int fd) {
+    ScopedTimer timer("CreateConnection");
+    addEpollFd(FdWrapper(fd, EPOLLIN | EPOLLHUP | EPOLLET));
+    connectionMap_[fd] = std::make_shared<Connection>(FdWrapper(fd, EPOLLIN | EPOLLHUP | EPOLLET), this);
+    if (static_cast<size_t>(fd) >= lastActive_.size()) {
+        lastActive_.resize(std::max<size_t>(fd + 1, lastActive_.size() * 2), 0);
     }
+    lastActive_[fd] = idleEpoch_;
+    spi_->onAccepted(connectionMap_[fd]);
 }
 
 void SubReactor::handleEvent(FdWrapper& fdw) {
-    if (fdw.fd() == pipeFds_[0]) {
-        handlePipe();
+    if (fdw.fd() == wakeupFd_) {
+        handleWakeup();
     } else if (fdw.fd() == timer_fd_) {
         handleTimerEvents();
+    } else if (acceptor_ && fdw.fd() == acceptor_->fd()) {
+        // 本线程 accept 的连接直接加入，不经过任务队列
+        acceptor_->acceptAll([this](int fd) { addConnection(fd); });
     } 
     else {
         if (fdw.events() & EPOLLIN) {
@@ -175,11 +196,8 @@ void SubReactor::handleEvent(FdWrapper& fdw) {
 }
 
 void SubReactor::handleRead(FdWrapper& fdw) {
-    constexpr size_t chunkSize = 1024 * 8;
-    char buffer[chunkSize];
-
-    ssize_t totalRead = 0;
     ssize_t n = 0;
+    int savedErrno = 0;
     ScopedTimer timer(__func__);
     
     auto it = connectionMap_.find(fdw.fd());
@@ -187,23 +205,34 @@ void SubReactor::handleRead(FdWrapper& fdw) {
         spdlog::warn("No connection found for fd={}", fdw.fd());
         return;
     }
+    // 持有引用，回调中关闭连接时不会提前析构
+    auto conn = it->second;
+    // 正在关闭的连接读端已 shutdown，读到的 0 不是对端断开，留给发送缓冲写完后关闭
+    if (conn->isClosing()) {
+        return;
+    }
+    SimpleBuffer& input = conn->inputBuffer();
+    // 只记扫描轮次，不取时间
+    lastActive_[fdw.fd()] = idleEpoch_;
     {
         ScopedTimer timer("ReadLoop");
+        // 边沿触发，读到 EAGAIN 为止
         do {
-            n = read(fdw.fd(), buffer, chunkSize);
+            n = input.readFd(fdw.fd(), &savedErrno);
             if (n > 0) {
-                totalRead += n;
-                spi_->onMessage(it->second, buffer, n);
+                spi_->onMessage(conn, input);
+                if (conn->isClosed() || conn->isClosing()) {
+                    return;
+                }
             }
-        } while (n > 0);
+        } while (n > 0 || (n < 0 && savedErrno == EINTR));
     }
-    
 
     // 处理读取结果
-    if (totalRead <= 0) {
+    if (n == 0 || (savedErrno != EAGAIN && savedErrno != EWOULDBLOCK)) {
         // 处理错误或连接关闭
-        spdlog::info("Connection closed or read error on fd={}, n = {}", fdw.fd(), n);
-        spi_->onDisconnected(connectionMap_[fdw.fd()], 1, "what can I say");
+        spdlog::info("Connection closed or read error on fd={}, n = {}, errno = {}", fdw.fd(), n, savedErrno);
+        spi_->onDisconnected(conn, 1, "what can I say");
         removeConnection(fdw);
     }
     
@@ -215,151 +244,139 @@ void SubReactor::handleWrite(FdWrapper fdw) {
         spdlog::warn("No connection found for fd={}", fdw.fd());
         return;
     }
-    it->second->sendBufferedData();
+    auto conn = it->second; // 写完可能触发关闭并移除连接
+    conn->sendBufferedData();
 
 }
 
 
+uint64_t SubReactor::nowTick() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
 int64_t SubReactor::registerTimer(int64_t interval_ms, std::function<void()> callback, bool recurring) {
     if (interval_ms <= 0 || !callback) {
         return -1; // 无效参数
     }
-    
-    auto now = std::chrono::steady_clock::now();
-    auto expiration = now + std::chrono::milliseconds(interval_ms);
-    
-    TimerInfo timer{
-        .id = next_timer_id_.fetch_add(1, std::memory_order_relaxed),
-        .interval_ms = interval_ms,
-        .callback = std::move(callback),
-        .recurring = recurring,
-        .expiration = expiration
-    };
-    spdlog::info("Registering timer with ID: {}, interval: {} ms, recurring: {}", timer.id, timer.interval_ms, timer.recurring);
-    {
-        std::lock_guard<std::mutex> lock(timers_mutex_);
-        auto [it, inserted] = timers_.insert(std::move(timer));
-        if (it == timers_.begin()) {
-            updateNextTimer(); // 如果是最近到期的定时器，更新 timerfd
-        }
+    if (isInLoopThread()) {
+        // 刻度向上取整，不会早于 interval_ms 触发
+        int64_t handle = timerWheel_.add(nowTick() + 1, interval_ms, std::move(callback), recurring);
+        rearmTimer();
+        return handle;
     }
-    
-    return timer.id;
-}
 
+    // 先分配编号，加入时间轮的动作交给 SubReactor 线程
+    int64_t id = next_timer_id_.fetch_add(1, std::memory_order_relaxed);
+    queueInLoop([this, id, interval_ms, callback = std::move(callback), recurring]() mutable {
+        auto wrapped = [this, id, callback = std::move(callback), recurring] {
+            if (!recurring) {
+                remoteTimers_.erase(id);
+            }
+            callback();
+        };
+        remoteTimers_[id] = timerWheel_.add(nowTick() + 1, interval_ms, std::move(wrapped), recurring);
+        rearmTimer();
+    });
+    return id;
+}
 
 // 取消定时器
 bool SubReactor::cancelTimer(int64_t timer_id) {
-    std::lock_guard<std::mutex> lock(timers_mutex_);
-    
-    auto it = std::find_if(timers_.begin(), timers_.end(), 
-        [timer_id](const TimerInfo& t) { return t.id == timer_id; });
-    
-    if (it == timers_.end()) {
-        return false; // 未找到
+    if (!isInLoopThread()) {
+        queueInLoop([this, timer_id] { cancelTimer(timer_id); });
+        return true;
     }
-    
-    bool was_first = (it == timers_.begin());
-    timers_.erase(it);
-    
-    if (was_first && !timers_.empty()) {
-        updateNextTimer(); // 如果删除的是最近到期的定时器，更新下一个
-    } else if (timers_.empty()) {
-        disableTimer(); // 没有定时器时禁用
+    // timerfd 不随取消重设，多出的一次唤醒在 handleTimerEvents 中什么也不做
+    if ((timer_id >> 32) == 0) {
+        auto it = remoteTimers_.find(timer_id);
+        if (it == remoteTimers_.end()) {
+            return false;
+        }
+        int64_t handle = it->second;
+        remoteTimers_.erase(it);
+        return timerWheel_.cancel(handle);
     }
-    
-    return true;
+    return timerWheel_.cancel(timer_id);
 }
 
-void SubReactor::updateNextTimer() {
-    // std::lock_guard<std::mutex> lock(timers_mutex_);
-    if (timers_.empty()) {
-        disableTimer();
+void SubReactor::rearmTimer() {
+    uint64_t next = timerWheel_.nextTick();
+    if (next >= armedTick_) {
         return;
     }
-    
-    const auto& next_timer = *timers_.begin();
-    auto now = std::chrono::steady_clock::now();
-    auto duration = next_timer.expiration - now;
-    
-    // 计算超时时间（毫秒转纳秒）
-    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
-    if (ns < 0) ns = 0; // 确保非负
-    
-    // 设置 timerfd
-    struct itimerspec new_value;
-    new_value.it_value.tv_sec = ns / 1000000000;
-    new_value.it_value.tv_nsec = ns % 1000000000;
-    new_value.it_interval = {0, 0}; // 单次触发
-    spdlog::info("Setting timerfd with expiration in {} ns", ns);
-    if (timerfd_settime(timer_fd_, 0, &new_value, nullptr) == -1) {
+    armedTick_ = next;
+
+    // 绝对时间，已过去的时刻立即触发
+    struct itimerspec new_value = {};
+    new_value.it_value.tv_sec = next / 1000;
+    new_value.it_value.tv_nsec = (next % 1000) * 1000000;
+    if (timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &new_value, nullptr) == -1) {
         spdlog::error("timerfd_settime failed");
         exit(-1);
     }
 }
 
-// 禁用定时器
-void SubReactor::disableTimer() {
-     struct itimerspec new_value = {};
-     timerfd_settime(timer_fd_, 0, &new_value, nullptr);
-}
-
-
-
 // 处理定时器事件
 void SubReactor::handleTimerEvents() {
     // 读取 timerfd 事件计数
-    spdlog::info("Handling timer events");
     uint64_t expirations;
     ssize_t n = read(timer_fd_, &expirations, sizeof(expirations));
     if (n != sizeof(expirations)) {
         // 处理读取错误
         return;
     }
-    
-    // 获取当前时间
-    auto now = std::chrono::steady_clock::now();
-    std::vector<TimerInfo> expired_timers;
-    std::vector<TimerInfo> recurring_timers;
-    
-    {
-        std::lock_guard<std::mutex> lock(timers_mutex_);
-        
-        // 收集所有过期定时器
-        for (auto it = timers_.begin(); it != timers_.end() && it->expiration <= now;) {
-            expired_timers.push_back(*it);
-            it = timers_.erase(it);
-        }
-        
-        // 处理周期性定时器
-        for (auto& timer : expired_timers) {
-            if (timer.recurring) {
-                TimerInfo new_timer = timer;
-                new_timer.expiration = now + std::chrono::milliseconds(timer.interval_ms);
-                recurring_timers.push_back(new_timer);
-            }
+
+    armedTick_ = TimingWheel::kNoTimer;
+    timerWheel_.advance(nowTick());
+    rearmTimer();
+}
+
+
+
+void SubReactor::setIdleTimeout(int64_t timeout_ms) {
+    runInLoop([this, timeout_ms] {
+        if (idleTimer_ != -1) {
+            cancelTimer(idleTimer_);
+            idleTimer_ = -1;
         }
-        
-        // 重新插入周期性定时器
-        for (auto& timer : recurring_timers) {
-            timers_.insert(std::move(timer));
+        if (timeout_ms <= 0) {
+            return;
         }
-        
-        // 更新下一个定时器
-        if (!timers_.empty()) {
-            updateNextTimer();
-        } else {
-            disableTimer();
+        int64_t interval = std::max<int64_t>(timeout_ms / kIdleSweeps, 1);
+        idleTimer_ = registerTimer(interval, [this] { sweepIdleConnections(); }, true);
+    });
+}
+
+void SubReactor::sweepIdleConnections() {
+    if (++idleEpoch_ == 0) {
+        idleEpoch_ = 1;
+    }
+    // 顺序扫描连续数组，百万连接也只是几 MB 的顺序读
+    idleFds_.clear();
+    for (size_t fd = 0; fd < lastActive_.size(); ++fd) {
+        uint32_t last = lastActive_[fd];
+        if (last != 0 && idleEpoch_ - last > kIdleSweeps) {
+            idleFds_.push_back(static_cast<int>(fd));
         }
     }
-    
-    // 执行过期定时器的回调（在锁外执行）
-    for (auto& timer : expired_timers) {
-        try {
-            timer.callback();
-        } catch (...) {
-            // 处理回调异常
+
+    for (int fd : idleFds_) {
+        auto it = connectionMap_.find(fd);
+        if (it == connectionMap_.end()) {
+            lastActive_[fd] = 0;
+            continue;
         }
+        auto conn = it->second;
+        spdlog::info("Idle connection timeout on fd={}", fd);
+        spi_->onDisconnected(conn, 4, "idle timeout");
+        if (!conn->isClosed()) {
+            conn->close(true);
+        }
+    }
+    if (!idleFds_.empty()) {
+        spdlog::info("Reaped {} idle connections", idleFds_.size());
     }
 }
 
@@ -0,0 +1,210 @@
+#include "TimingWheel.hpp"
+#include <algorithm>
+
+namespace {
+
+// 循环右移，n 为 0 时不移
+uint64_t rotateRight(uint64_t bits, unsigned n) {
+    return n == 0 ? bits : (bits >> n) | (bits << (64 - n));
+}
+
+} // namespace
+
+TimingWheel::TimingWheel(uint64_t now) : current_(now) {
+    for (auto& level : heads_) {
+        std::fill(std::begin(level), std::end(level), kNil);
+    }
+}
+
+int64_t TimingWheel::add(uint64_t now, uint64_t delay, Callback callback, bool recurring) {
+    uint32_t index = allocate();
+    Node& node = nodes_[index];
+    node.interval = std::max<uint64_t>(delay, 1);
+    node.expire = std::max(now, current_) + node.interval;
+    node.callback = std::move(callback);
+    node.recurring = recurring;
+    link(index);
+    return static_cast<int64_t>(node.generation) << 32 | index;
+}
+
+bool TimingWheel::cancel(int64_t handle) {
+    if (handle < 0) {
+        return false;
+    }
+    uint32_t index = static_cast<uint32_t>(handle);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (index >= nodes_.size() || nodes_[index].generation != generation) {
+        return false;
+    }
+    Node& node = nodes_[index];
+    switch (node.state) {
+    case State::Linked:
+        unlink(index);
+        release(index);
+        return true;
+    case State::Expired:
+    case State::Firing:
+        // 正在 expire() 中，由它回收
+        node.state = State::Cancelled;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void TimingWheel::advance(uint64_t now) {
+    while (current_ < now) {
+        // 中间没有到期也没有降级的刻度直接跳过
+        uint64_t next = nextTick();
+        if (next > now) {
+            current_ = now;
+            break;
+        }
+        current_ = next - 1;
+        step();
+    }
+}
+
+uint64_t TimingWheel::nextTick() const {
+    uint64_t next = kNoTimer;
+    for (int level = 0; level < kLevels; ++level) {
+        if (occupied_[level] == 0) {
+            continue;
+        }
+        unsigned shift = level * kSlotBits;
+        uint64_t base = current_ >> shift;
+        unsigned from = (base + 1) & (kSlots - 1);
+        // 从当前槽的下一个开始循环查找第一个非空槽，距离 1~64
+        uint64_t distance = __builtin_ctzll(rotateRight(occupied_[level], from)) + 1;
+        // 第 0 层即到期时刻，高层是该槽降级的时刻
+        next = std::min(next, (base + distance) << shift);
+    }
+    return next;
+}
+
+uint32_t TimingWheel::allocate() {
+    uint32_t index;
+    if (freeList_.empty()) {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    } else {
+        index = freeList_.back();
+        freeList_.pop_back();
+    }
+    ++size_;
+    return index;
+}
+
+void TimingWheel::release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.callback = nullptr;
+    node.state = State::Free;
+    // 代数保持为正，句柄不会是负数
+    node.generation = node.generation == INT32_MAX ? 1 : node.generation + 1;
+    freeList_.push_back(index);
+    --size_;
+}
+
+void TimingWheel::link(uint32_t index) {
+    Node& node = nodes_[index];
+    // 降级时可能正好在当前刻度到期，放进第 0 层当前槽，随后就会执行
+    uint64_t diff = node.expire > current_ ? node.expire - current_ : 0;
+    int level = 0;
+    while (level < kLevels - 1 && diff >= (1ull << ((level + 1) * kSlotBits))) {
+        ++level;
+    }
+    if (level == kLevels - 1 && diff >= (1ull << (kLevels * kSlotBits))) {
+        node.expire = current_ + (1ull << (kLevels * kSlotBits)) - 1;
+    }
+    uint32_t slot = (node.expire >> (level * kSlotBits)) & (kSlots - 1);
+
+    node.level = static_cast<uint8_t>(level);
+    node.slot = static_cast<uint8_t>(slot);
+    node.state = State::Linked;
+    node.prev = kNil;
+    node.next = heads_[level][slot];
+    if (node.next != kNil) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[level][slot] = index;
+    occupied_[level] |= 1ull << slot;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.level][node.slot] = node.next;
+        if (node.next == kNil) {
+            occupied_[node.level] &= ~(1ull << node.slot);
+        }
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = kNil;
+    node.next = kNil;
+}
+
+void TimingWheel::cascade(int level) {
+    uint32_t slot = (current_ >> (level * kSlotBits)) & (kSlots - 1);
+    uint32_t index = heads_[level][slot];
+    heads_[level][slot] = kNil;
+    occupied_[level] &= ~(1ull << slot);
+    while (index != kNil) {
+        uint32_t next = nodes_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimingWheel::expire() {
+    uint32_t slot = current_ & (kSlots - 1);
+    uint32_t index = heads_[0][slot];
+    heads_[0][slot] = kNil;
+    occupied_[0] &= ~(1ull << slot);
+    // 先摘下整槽，回调中新加的定时器即使落在同一槽也留到下一圈
+    expired_.clear();
+    for (; index != kNil; index = nodes_[index].next) {
+        nodes_[index].state = State::Expired;
+        expired_.push_back(index);
+    }
+
+    for (size_t i = 0; i < expired_.size(); ++i) {
+        index = expired_[i];
+        if (nodes_[index].state == State::Cancelled) {
+            release(index);
+            continue;
+        }
+        nodes_[index].state = State::Firing;
+        // 回调中加定时器可能使 nodes_ 扩容，不能持有引用
+        Callback callback = std::move(nodes_[index].callback);
+        try {
+            callback();
+        } catch (...) {
+            // 处理回调异常
+        }
+        Node& node = nodes_[index];
+        if (node.recurring && node.state == State::Firing) {
+            node.callback = std::move(callback);
+            node.expire = current_ + node.interval;
+            link(index);
+        } else {
+            release(index);
+        }
+    }
+}
+
+void TimingWheel::step() {
+    ++current_;
+    // 低位全为 0 的层从高到低依次降级，高层降下来的定时器可能还要继续降
+    int top = 0;
+    while (top + 1 < kLevels && (current_ & ((1ull << ((top + 1) * kSlotBits)) - 1)) == 0) {
+        ++top;
+    }
+    for (int level = top; level >= 1; --level) {
+        cascade(level);
+    }
+    expire();
+}
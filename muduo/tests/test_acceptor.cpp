@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Acceptor.hpp"
+#include "spdlog/spdlog.h"
+
+// fd 耗尽时 acceptAll 丢弃积压的连接后返回，不在 EMFILE 上空转
+
+namespace {
+
+int connectTo(const Acceptor& acceptor) {
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    getsockname(acceptor.fd(), reinterpret_cast<sockaddr*>(&addr), &len);
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 子进程中调用 acceptAll，超时未返回则杀掉；返回子进程退出码，超时为 -1
+int runWithTimeout(void (*body)(Acceptor&), Acceptor& acceptor, std::chrono::milliseconds timeout) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        body(acceptor);
+        _exit(0);
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    int status = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return -1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+void acceptWithoutFds(Acceptor& acceptor) {
+    rlimit limit = {64, 64};
+    if (setrlimit(RLIMIT_NOFILE, &limit) < 0) {
+        _exit(2);
+    }
+    // 占满剩余的 fd
+    while (open("/dev/null", O_RDONLY) >= 0) {
+    }
+    if (errno != EMFILE) {
+        _exit(3);
+    }
+    int accepted = acceptor.acceptAll([](int fd) { close(fd); });
+    _exit(accepted == 0 ? 0 : 1);
+}
+
+TEST(Acceptor, ReturnsWhenFdsExhausted) {
+    spdlog::set_level(spdlog::level::off);
+    Acceptor acceptor;
+    acceptor.bindAddress("127.0.0.1", 0);
+    int client = connectTo(acceptor);
+    ASSERT_GE(client, 0);
+
+    EXPECT_EQ(runWithTimeout(acceptWithoutFds, acceptor, std::chrono::milliseconds(2000)), 0);
+
+    // 积压的连接被接受后立即关闭，客户端读到 EOF
+    timeval timeout = {2, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char byte;
+    EXPECT_EQ(read(client, &byte, 1), 0);
+    close(client);
+}
+
+TEST(Acceptor, AcceptsUntilBacklogEmpty) {
+    spdlog::set_level(spdlog::level::off);
+    Acceptor acceptor;
+    acceptor.bindAddress("127.0.0.1", 0);
+    std::vector<int> clients;
+    for (int i = 0; i < 8; ++i) {
+        clients.push_back(connectTo(acceptor));
+        ASSERT_GE(clients.back(), 0);
+    }
+    std::vector<int> accepted;
+    EXPECT_EQ(acceptor.acceptAll([&](int fd) { accepted.push_back(fd); }), 8);
+    EXPECT_EQ(acceptor.acceptAll([&](int fd) { accepted.push_back(fd); }), 0);
+    for (int fd : accepted) {
+        EXPECT_TRUE(fcntl(fd, F_GETFL) & O_NONBLOCK);
+        close(fd);
+    }
+    for (int fd : clients) {
+        close(fd);
+    }
+}
+
+} // namespace
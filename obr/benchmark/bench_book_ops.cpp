@@ -0,0 +1,322 @@
+/**
+ * @file bench_book_ops.cpp
+ * @brief per-operation cost of OrderBook on session-shaped books
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Every benchmark iteration is one operation, so Time is ns/op, and
+ * allocs/op counts global operator new calls made by the timed operations.
+ * Prices sit at a Zipf-distributed number of ticks from the mid, most
+ * orders near the touch and a long thin tail, as in A-share sessions.
+ *
+ * Arguments: price levels per side, Zipf exponent x 100 and, for the mixed
+ * session, the percentage of orders that are cancelled later.
+ */
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "full_order.h"
+
+namespace {
+
+uint64_t gAllocations = 0;
+
+}  // namespace
+
+// 只替换 operator new 计数，库自带的 operator delete 以 free 释放
+__attribute__((noinline)) void* operator new(std::size_t size) {
+  ++gAllocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+namespace {
+
+using orderbook::BookOrder;
+using orderbook::OrderBook;
+
+constexpr int64_t kMid = 1000000;  // 100.00 元，涨跌停内有 1000 档
+constexpr int64_t kTick = 100;
+constexpr size_t kStream = 1 << 16;
+
+/**
+ * @brief allocations made while the benchmark timer runs
+ */
+class AllocationCounter {
+ public:
+  AllocationCounter() : since_(gAllocations) {}
+
+  void pause() { counted_ += gAllocations - since_; }
+  void resume() { since_ = gAllocations; }
+
+  void report(benchmark::State& state) {
+    pause();
+    state.counters["allocs/op"] = benchmark::Counter(
+        static_cast<double>(counted_), benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  uint64_t since_;
+  uint64_t counted_ = 0;
+};
+
+// 距中间价的档数：P(d) 正比于 1 / (d + 1)^s
+class ZipfTicks {
+ public:
+  ZipfTicks(int levels, double exponent) : cdf_(levels) {
+    double sum = 0;
+    for (int d = 0; d < levels; ++d) {
+      sum += 1.0 / std::pow(d + 1, exponent);
+      cdf_[d] = sum;
+    }
+    for (double& p : cdf_) {
+      p /= sum;
+    }
+  }
+
+  int64_t operator()(std::mt19937_64& rng) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    return std::min<int64_t>(it - cdf_.begin(), cdf_.size() - 1);
+  }
+
+ private:
+  std::vector<double> cdf_;
+};
+
+/**
+ * @brief order generator for one workload shape taken from the arguments
+ */
+class SessionFlow {
+ public:
+  explicit SessionFlow(const benchmark::State& state)
+      : ticks_(static_cast<int>(state.range(0)), state.range(1) / 100.0),
+        rng_(17) {}
+
+  /**
+   * @param crossed shift both sides through the mid, as in a call auction
+   */
+  BookOrder order(bool crossed = false) {
+    int8_t side = static_cast<int8_t>(1 + rng_() % 2);
+    int64_t ticks = ticks_(rng_) - (crossed ? 5 : 0);
+    int64_t price =
+        side == 1 ? kMid - ticks * kTick : kMid + (1 + ticks) * kTick;
+    // 七成散户小单 1~10 手，其余 10~500 手
+    uint64_t lots = rng_() % 10 < 7 ? 1 + rng_() % 10 : 10 + rng_() % 491;
+    return BookOrder{++id_, price, lots * 100, side};
+  }
+
+  std::vector<BookOrder> orders(size_t count, bool crossed = false) {
+    std::vector<BookOrder> orders;
+    orders.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      orders.push_back(order(crossed));
+    }
+    return orders;
+  }
+
+  std::mt19937_64& rng() { return rng_; }
+
+ private:
+  ZipfTicks ticks_;
+  std::mt19937_64 rng_;
+  uint64_t id_ = 0;
+};
+
+void fill(OrderBook& book, const std::vector<BookOrder>& orders) {
+  book.reset();
+  for (const BookOrder& order : orders) {
+    book.addOrder(order);
+  }
+}
+
+void BM_Insert(benchmark::State& state) {
+  SessionFlow flow(state);
+  std::vector<BookOrder> orders = flow.orders(kStream);
+  OrderBook book;
+  size_t next = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    if (next == orders.size()) {
+      state.PauseTiming();
+      allocations.pause();
+      book.reset();
+      next = 0;
+      allocations.resume();
+      state.ResumeTiming();
+    }
+    book.addOrder(orders[next++]);
+  }
+  allocations.report(state);
+}
+
+void BM_Cancel(benchmark::State& state) {
+  SessionFlow flow(state);
+  std::vector<BookOrder> orders = flow.orders(kStream);
+  std::vector<uint64_t> ids;
+  for (const BookOrder& order : orders) {
+    ids.push_back(order.id);
+  }
+  std::shuffle(ids.begin(), ids.end(), flow.rng());
+  OrderBook book;
+  fill(book, orders);
+  size_t next = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    if (next == ids.size()) {
+      state.PauseTiming();
+      allocations.pause();
+      fill(book, orders);
+      next = 0;
+      allocations.resume();
+      state.ResumeTiming();
+    }
+    book.cancelOrder(ids[next++]);
+  }
+  allocations.report(state);
+}
+
+// 成交总落在最优价位的队首，两侧交替各吃 5 手
+void BM_Fill(benchmark::State& state) {
+  SessionFlow flow(state);
+  std::vector<BookOrder> orders = flow.orders(kStream);
+  OrderBook book;
+  fill(book, orders);
+  bool buy = false;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    buy = !buy;
+    const orderbook::PriceLadder& side = buy ? book.bids() : book.asks();
+    int64_t level = buy ? side.highest() : side.lowest();
+    if (level == orderbook::PriceLadder::kNone) {
+      state.PauseTiming();
+      allocations.pause();
+      fill(book, orders);
+      allocations.resume();
+      state.ResumeTiming();
+      continue;
+    }
+    const BookOrder& head = book.order(side.level(level).head);
+    book.fillOrder(head.id, 500);
+  }
+  allocations.report(state);
+}
+
+void BM_TopN(benchmark::State& state) {
+  SessionFlow flow(state);
+  OrderBook book;
+  fill(book, flow.orders(kStream));
+  orderbook::DepthLevel levels[orderbook::MarketSnapshot::kDepth];
+  bool buy = false;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    buy = !buy;
+    benchmark::DoNotOptimize(
+        book.depth(buy, levels, orderbook::MarketSnapshot::kDepth));
+    benchmark::ClobberMemory();
+  }
+  allocations.report(state);
+}
+
+// 集合竞价：每笔委托进入交叉的订单簿后重算虚拟成交价、量与笔数
+void BM_AuctionEquilibrium(benchmark::State& state) {
+  SessionFlow flow(state);
+  std::vector<BookOrder> orders = flow.orders(kStream, true);
+  OrderBook book;
+  size_t next = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    if (next == orders.size()) {
+      state.PauseTiming();
+      allocations.pause();
+      book.reset();
+      next = 0;
+      allocations.resume();
+      state.ResumeTiming();
+    }
+    book.addOrder(orders[next++]);
+    benchmark::DoNotOptimize(book.auctionStatus());
+  }
+  allocations.report(state);
+}
+
+// 连续竞价的委托流：range(2)% 的委托在之后 1~512 笔内撤单
+void BM_Session(benchmark::State& state) {
+  struct Step {
+    bool cancel;
+    BookOrder order;
+  };
+  SessionFlow flow(state);
+  std::vector<std::pair<uint64_t, Step>> timed;
+  for (size_t i = 0; i < kStream; ++i) {
+    BookOrder order = flow.order();
+    timed.push_back({i * 1024, Step{false, order}});
+    if (static_cast<int64_t>(flow.rng()() % 100) < state.range(2)) {
+      uint64_t cancelAt = i * 1024 + 1024 * (1 + flow.rng()() % 512) + 1;
+      timed.push_back({cancelAt, Step{true, order}});
+    }
+  }
+  std::sort(timed.begin(), timed.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  OrderBook book;
+  size_t next = 0;
+  AllocationCounter allocations;
+  for (auto _ : state) {
+    if (next == timed.size()) {
+      state.PauseTiming();
+      allocations.pause();
+      book.reset();
+      next = 0;
+      allocations.resume();
+      state.ResumeTiming();
+    }
+    const Step& step = timed[next++].second;
+    if (step.cancel) {
+      book.cancelOrder(step.order.id);
+    } else {
+      book.addOrder(step.order);
+    }
+  }
+  allocations.report(state);
+}
+
+// 参数：每侧档位数、Zipf 指数 ×100
+void bookShapes(benchmark::internal::Benchmark* bench) {
+  for (int64_t levels : {20, 200, 1000}) {
+    for (int64_t exponent : {80, 120}) {
+      bench->Args({levels, exponent});
+    }
+  }
+}
+
+// 参数：每侧档位数、Zipf 指数 ×100、撤单比例（%）
+void sessionShapes(benchmark::internal::Benchmark* bench) {
+  for (int64_t levels : {20, 200}) {
+    for (int64_t cancelPercent : {50, 80, 95}) {
+      bench->Args({levels, 100, cancelPercent});
+    }
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_Insert)->Apply(bookShapes);
+BENCHMARK(BM_Cancel)->Apply(bookShapes);
+BENCHMARK(BM_Fill)->Apply(bookShapes);
+BENCHMARK(BM_TopN)->Apply(bookShapes);
+BENCHMARK(BM_AuctionEquilibrium)->Apply(bookShapes);
+BENCHMARK(BM_Session)->Apply(sessionShapes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,73 @@
+/**
+ * @file bench_call_auction.cpp
+ * @brief scalar vs AVX2 equilibrium search over fully crossed windows
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "equilibrium_search.h"
+
+namespace {
+
+// 买卖双方铺满 range(0) 个价位且整体交叉，即全量重算时的扫描窗口
+struct CrossedWindow {
+  explicit CrossedWindow(size_t size)
+      : bidQty(size), askQty(size), cumBid(size), cumAsk(size) {
+    std::mt19937_64 rng(5);
+    for (size_t i = 0; i < size; ++i) {
+      // 约三成价位为空，数量取整手
+      bidQty[i] = rng() % 10 < 3 ? 0 : (1 + rng() % 50) * 100;
+      askQty[i] = rng() % 10 < 3 ? 0 : (1 + rng() % 50) * 100;
+    }
+    uint64_t sum = 0;
+    for (size_t i = size; i-- > 0;) {
+      sum += bidQty[i];
+      cumBid[i] = sum;
+    }
+    sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+      sum += askQty[i];
+      cumAsk[i] = sum;
+    }
+  }
+
+  orderbook::AuctionLevels levels() const {
+    return {bidQty.data(), askQty.data(), cumBid.data(), cumAsk.data(),
+            bidQty.size()};
+  }
+
+  std::vector<uint64_t> bidQty;
+  std::vector<uint64_t> askQty;
+  std::vector<uint64_t> cumBid;
+  std::vector<uint64_t> cumAsk;
+};
+
+template <size_t (*Search)(const orderbook::AuctionLevels&)>
+void BM_Equilibrium(benchmark::State& state) {
+  CrossedWindow window(state.range(0));
+  orderbook::AuctionLevels levels = window.levels();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Search(levels));
+  }
+  state.SetItemsProcessed(state.iterations() * levels.size);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Equilibrium, orderbook::searchEquilibriumScalar)
+    ->Arg(256)
+    ->Arg(2048)
+    ->Arg(16384);
+BENCHMARK_TEMPLATE(BM_Equilibrium, orderbook::searchEquilibriumAvx2)
+    ->Arg(256)
+    ->Arg(2048)
+    ->Arg(16384);
+
+BENCHMARK_MAIN();
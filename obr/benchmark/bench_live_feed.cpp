@@ -0,0 +1,145 @@
+/**
+ * @file bench_live_feed.cpp
+ * @brief decode cost and tick-to-book cost of a decompressed feed block
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "live_feed.h"
+
+namespace {
+
+constexpr uint64_t kContinuous = 20250707100000000ULL;  // 连续竞价时段
+
+class BlockWriter {
+ public:
+  void order(uint32_t secid, uint64_t id, int64_t price, bool buy) {
+    header(orderbook::kFeedOrderMsgType, 51);
+    u16(1);
+    i64(static_cast<int64_t>(id));
+    text("011", 3);
+    security(secid);
+    text("102", 4);
+    i64(price);
+    i64(100 * 100);
+    block_.push_back(buy ? '1' : '2');
+    i64(static_cast<int64_t>(kContinuous));
+    block_.push_back('2');
+    u32(0);
+  }
+
+  void cancel(uint32_t secid, uint64_t id, int64_t price, bool buy) {
+    header(orderbook::kFeedTradeMsgType, 66);
+    u16(1);
+    i64(static_cast<int64_t>(id + (1ULL << 40)));
+    text("011", 3);
+    i64(buy ? static_cast<int64_t>(id) : 0);
+    i64(buy ? 0 : static_cast<int64_t>(id));
+    security(secid);
+    text("102", 4);
+    i64(price);
+    i64(100 * 100);
+    block_.push_back('4');
+    i64(static_cast<int64_t>(kContinuous));
+    u32(0);
+  }
+
+  const std::vector<char>& block() const { return block_; }
+
+ private:
+  void header(uint32_t type, uint32_t length) {
+    u32(type);
+    u32(length);
+  }
+
+  void u16(uint16_t value) { put(__builtin_bswap16(value)); }
+  void u32(uint32_t value) { put(__builtin_bswap32(value)); }
+  void i64(int64_t value) {
+    put(__builtin_bswap64(static_cast<uint64_t>(value)));
+  }
+
+  void text(const char* value, size_t size) {
+    block_.insert(block_.end(), value, value + size);
+  }
+
+  void security(uint32_t secid) {
+    char code[9];
+    std::snprintf(code, sizeof(code), "%06u  ", secid);
+    text(code, 8);
+  }
+
+  template <typename T>
+  void put(T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    block_.insert(block_.end(), bytes, bytes + sizeof(value));
+  }
+
+  std::vector<char> block_;
+};
+
+// range(0) 只证券交错的 kOrders 笔委托及其撤单，重复送入时订单簿回到原状
+std::vector<char> makeBlock(uint32_t securities) {
+  constexpr size_t kOrders = 512;
+  std::mt19937_64 rng(11);
+  BlockWriter writer;
+  struct Placed {
+    uint32_t secid;
+    uint64_t id;
+    int64_t price;
+    bool buy;
+  };
+  std::vector<Placed> placed;
+  for (size_t i = 0; i < kOrders; ++i) {
+    bool buy = rng() % 2 == 0;
+    // 买在 10.00 以下、卖在 10.01 以上，互不成交
+    int64_t price = buy ? 100000 - static_cast<int64_t>(rng() % 20) * 100
+                        : 100100 + static_cast<int64_t>(rng() % 20) * 100;
+    Placed order{300001 + static_cast<uint32_t>(rng() % securities), i + 1,
+                 price, buy};
+    writer.order(order.secid, order.id, order.price, order.buy);
+    placed.push_back(order);
+  }
+  for (const Placed& order : placed) {
+    writer.cancel(order.secid, order.id, order.price, order.buy);
+  }
+  return writer.block();
+}
+
+void BM_Decode(benchmark::State& state) {
+  std::vector<char> block = makeBlock(static_cast<uint32_t>(state.range(0)));
+  std::vector<orderbook::Event> events(block.size() / 60);
+  size_t count = 0;
+  for (auto _ : state) {
+    size_t consumed = 0;
+    count = orderbook::FeedDecoder::decode(block.data(), block.size(),
+                                           events.data(), events.size(),
+                                           consumed);
+    benchmark::DoNotOptimize(events.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Decode)->Arg(1)->Arg(200);
+
+void BM_OnBlock(benchmark::State& state) {
+  std::vector<char> block = makeBlock(static_cast<uint32_t>(state.range(0)));
+  orderbook::LiveFeed feed(orderbook::MarketType::MAIN_BOARD);
+  size_t count = feed.onBlock(block.data(), block.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(feed.onBlock(block.data(), block.size()));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_OnBlock)->Arg(1)->Arg(20)->Arg(200);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,148 @@
+/**
+ * @file bench_order_book.cpp
+ * @brief ladder OrderBook vs std::map / std::list MapOrderBook
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "full_order.h"
+#include "map_order_book.h"
+
+namespace {
+
+using orderbook::BookOrder;
+
+// 集合竞价形态：买卖双方围绕 10.00 元交叉，价格以 0.01 元为最小变动单位
+std::vector<BookOrder> auctionOrders(size_t count, int levels) {
+  std::mt19937_64 rng(42);
+  std::normal_distribution<double> offset(0.0, levels / 6.0);
+  std::vector<BookOrder> orders;
+  orders.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    int8_t side = static_cast<int8_t>(1 + rng() % 2);
+    int64_t ticks = static_cast<int64_t>(offset(rng));
+    // 买单偏高、卖单偏低，形成交叉区域
+    ticks += side == 1 ? 2 : -2;
+    orders.push_back(BookOrder{i, 100000 + ticks * 100,
+                               (1 + rng() % 50) * 100, side});
+  }
+  return orders;
+}
+
+struct BookEvent {
+  bool cancel;
+  BookOrder order;
+};
+
+// 连续竞价形态的委托流：cancelPercent% 的委托在之后 1~512 个事件内被撤单
+std::vector<BookEvent> cancelHeavyStream(size_t count, int cancelPercent) {
+  std::mt19937_64 rng(11);
+  std::vector<std::pair<uint64_t, BookEvent>> timed;
+  timed.reserve(count * 2);
+  for (uint64_t i = 0; i < count; ++i) {
+    int8_t side = static_cast<int8_t>(1 + rng() % 2);
+    int64_t ticks = static_cast<int64_t>(rng() % 21) - 10;
+    BookOrder order{i + 1, 100000 + ticks * 100, (1 + rng() % 50) * 100, side};
+    timed.push_back({i * 1024, BookEvent{false, order}});
+    if (static_cast<int>(rng() % 100) < cancelPercent) {
+      timed.push_back({i * 1024 + 1024 * (1 + rng() % 512) + 1,
+                       BookEvent{true, order}});
+    }
+  }
+  std::sort(timed.begin(), timed.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.first < rhs.first;
+            });
+  std::vector<BookEvent> events;
+  events.reserve(timed.size());
+  for (const auto& entry : timed) {
+    events.push_back(entry.second);
+  }
+  return events;
+}
+
+template <typename Book>
+void BM_CancelHeavy(benchmark::State& state) {
+  auto events = cancelHeavyStream(state.range(0),
+                                  static_cast<int>(state.range(1)));
+  for (auto _ : state) {
+    Book book;
+    for (const auto& event : events) {
+      if (event.cancel) {
+        book.cancelOrder(event.order.id);
+      } else {
+        book.addOrder(event.order);
+      }
+    }
+    benchmark::DoNotOptimize(book);
+  }
+  state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+template <typename Book>
+void BM_Insert(benchmark::State& state) {
+  auto orders = auctionOrders(state.range(0), 200);
+  for (auto _ : state) {
+    Book book;
+    for (const auto& order : orders) {
+      book.addOrder(order);
+    }
+    benchmark::DoNotOptimize(book);
+  }
+  state.SetItemsProcessed(state.iterations() * orders.size());
+}
+
+void BM_MapTop5(benchmark::State& state) {
+  orderbook::MapOrderBook book;
+  for (const auto& order : auctionOrders(state.range(0), 200)) {
+    book.addOrder(order);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(book.flushStatus());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LadderTop5(benchmark::State& state) {
+  orderbook::OrderBook book;
+  for (const auto& order : auctionOrders(state.range(0), 200)) {
+    book.addOrder(order);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(book.refreshStatus());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Insert, orderbook::MapOrderBook)
+    ->Arg(1 << 10)
+    ->Arg(1 << 14)
+    ->Arg(1 << 17);
+BENCHMARK_TEMPLATE(BM_Insert, orderbook::OrderBook)
+    ->Arg(1 << 10)
+    ->Arg(1 << 14)
+    ->Arg(1 << 17);
+// 参数：委托笔数、撤单比例（%）
+BENCHMARK_TEMPLATE(BM_CancelHeavy, orderbook::MapOrderBook)
+    ->Args({1 << 14, 70})
+    ->Args({1 << 14, 90});
+BENCHMARK_TEMPLATE(BM_CancelHeavy, orderbook::OrderBook)
+    ->Args({1 << 14, 70})
+    ->Args({1 << 14, 90})
+    ->Args({1 << 20, 70})
+    ->Args({1 << 20, 80})
+    ->Args({1 << 20, 90});
+BENCHMARK(BM_MapTop5)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+BENCHMARK(BM_LadderTop5)->Arg(1 << 10)->Arg(1 << 14)->Arg(1 << 17);
+
+BENCHMARK_MAIN();
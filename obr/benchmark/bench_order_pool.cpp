@@ -0,0 +1,149 @@
+/**
+ * @file bench_order_pool.cpp
+ * @brief slab-pooled intrusive level queues vs one std::list per level
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "order_pool.h"
+#include "price_ladder.h"
+
+namespace {
+
+using orderbook::BookOrder;
+
+constexpr uint32_t kLevels = 400;
+const orderbook::PriceGrid kGrid{80000, 100, kLevels};
+
+// 集合竞价形态：价格集中在网格中部，id 即下标
+std::vector<BookOrder> burstOrders(size_t count) {
+  std::mt19937_64 rng(7);
+  std::normal_distribution<double> offset(kLevels / 2.0, kLevels / 12.0);
+  std::vector<BookOrder> orders;
+  orders.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto level = static_cast<uint32_t>(
+        std::min<double>(std::max(offset(rng), 0.0), kLevels - 1));
+    orders.push_back(BookOrder{i, kGrid.price(level), (1 + rng() % 50) * 100,
+                               static_cast<int8_t>(1 + rng() % 2)});
+  }
+  return orders;
+}
+
+// 原实现：每档一个 std::list，每笔委托一次 malloc / free
+class ListLevels {
+ public:
+  explicit ListLevels(size_t orders) : levels_(kLevels), handles_(orders) {}
+
+  void add(const BookOrder& order) {
+    auto& level = levels_[kGrid.index(order.price)];
+    handles_[order.id] = level.insert(level.end(), order);
+  }
+
+  void cancel(const BookOrder& order) {
+    levels_[kGrid.index(order.price)].erase(handles_[order.id]);
+  }
+
+  void reset() {
+    for (auto& level : levels_) {
+      level.clear();
+    }
+  }
+
+ private:
+  std::vector<std::list<BookOrder>> levels_;
+  std::vector<std::list<BookOrder>::iterator> handles_;
+};
+
+// OrderBook 的做法：节点来自 slab 池，按下标侵入式链入价位队列
+class PoolLevels {
+ public:
+  explicit PoolLevels(size_t orders) : handles_(orders) {
+    ladder_.reset(kGrid);
+  }
+
+  void add(const BookOrder& order) {
+    uint32_t node = pool_.allocate(order);
+    ladder_.append(pool_, node);
+    handles_[order.id] = node;
+  }
+
+  void cancel(const BookOrder& order) {
+    uint32_t node = handles_[order.id];
+    ladder_.unlink(pool_, node);
+    pool_.release(node);
+  }
+
+  void reset() {
+    pool_.reset();
+    ladder_.reset(kGrid);
+  }
+
+ private:
+  orderbook::OrderPool pool_;
+  orderbook::PriceLadder ladder_;
+  std::vector<uint32_t> handles_;
+};
+
+// 一次迭代即一个交易日：开盘集中申报 range(0) 笔后全部清空
+template <typename Levels>
+void BM_Burst(benchmark::State& state) {
+  auto orders = burstOrders(state.range(0));
+  Levels levels(orders.size());
+  for (auto _ : state) {
+    for (const auto& order : orders) {
+      levels.add(order);
+    }
+    levels.reset();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * orders.size());
+}
+
+// 保持 range(0) 笔挂单，每步撤一笔随机挂单再补一笔
+template <typename Levels>
+void BM_Churn(benchmark::State& state) {
+  size_t resting = state.range(0);
+  auto orders = burstOrders(resting * 2);
+  Levels levels(orders.size());
+  std::vector<size_t> live(resting);
+  for (size_t i = 0; i < resting; ++i) {
+    levels.add(orders[i]);
+    live[i] = i;
+  }
+  std::mt19937_64 rng(3);
+  size_t next = resting;
+  for (auto _ : state) {
+    size_t& slot = live[rng() % resting];
+    levels.cancel(orders[slot]);
+    // 复用已撤委托的记录，id 不会与挂单冲突
+    levels.add(orders[next]);
+    std::swap(slot, next);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Burst, ListLevels)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Burst, PoolLevels)
+    ->Arg(1 << 12)
+    ->Arg(1 << 16)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Churn, ListLevels)->Arg(1 << 12)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_Churn, PoolLevels)->Arg(1 << 12)->Arg(1 << 18);
+
+BENCHMARK_MAIN();
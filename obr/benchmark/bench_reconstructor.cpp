@@ -0,0 +1,96 @@
+/**
+ * @file bench_reconstructor.cpp
+ * @brief per-event virtual calls vs the processEvents batch entry point
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "reconstructor.h"
+
+namespace {
+
+using orderbook::Event;
+using orderbook::Order;
+using orderbook::OrderType;
+using orderbook::Trade;
+using orderbook::TradeType;
+
+Trade cancelOf(const Order& order) {
+  return Trade{order.timestamp, 0, order.is_buy ? order.order_id : 0,
+               order.is_buy ? 0 : order.order_id, 0, 0, order.quantity,
+               order.is_buy, TradeType::CANCEL};
+}
+
+// 连续竞价形态：限价单围绕 10.00 元，簿内保持 depth 笔委托，
+// 超出后随机撤单；流末尾撤掉剩余委托，回放一遍后订单簿回到空
+std::vector<Event> eventStream(size_t orders, size_t depth) {
+  std::mt19937_64 rng(7);
+  std::vector<Event> events;
+  std::vector<Order> live;
+  events.reserve(orders * 2);
+  uint64_t timestamp = 20250707093000000ULL;
+  for (uint64_t id = 1; id <= orders; ++id, ++timestamp) {
+    int64_t ticks = static_cast<int64_t>(rng() % 101) - 50;
+    Order order{timestamp,        id,
+                100000 + ticks * 100, 0,
+                static_cast<uint32_t>(1 + rng() % 50) * 100,
+                rng() % 2 == 0,   OrderType::LIMIT};
+    events.push_back(Event::of(order));
+    live.push_back(order);
+    if (live.size() > depth) {
+      size_t k = rng() % live.size();
+      events.push_back(Event::of(cancelOf(live[k])));
+      live[k] = live.back();
+      live.pop_back();
+    }
+  }
+  for (const Order& order : live) {
+    events.push_back(Event::of(cancelOf(order)));
+  }
+  return events;
+}
+
+void BM_PerEvent(benchmark::State& state) {
+  auto events = eventStream(1 << 20, state.range(0));
+  auto reconstructor =
+      orderbook::createReconstructor(orderbook::MarketType::MAIN_BOARD, false,
+                                     state.range(0));
+  for (auto _ : state) {
+    for (const Event& event : events) {
+      if (event.type == orderbook::EventType::ORDER) {
+        reconstructor->processOrder(event.order);
+      } else {
+        reconstructor->processTrade(event.trade);
+      }
+    }
+    benchmark::DoNotOptimize(reconstructor->book().bestBid());
+  }
+  state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+void BM_Batch(benchmark::State& state) {
+  auto events = eventStream(1 << 20, state.range(0));
+  auto reconstructor =
+      orderbook::createReconstructor(orderbook::MarketType::MAIN_BOARD, false,
+                                     state.range(0));
+  for (auto _ : state) {
+    reconstructor->processEvents(events.data(), events.size());
+    benchmark::DoNotOptimize(reconstructor->book().bestBid());
+  }
+  state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+}  // namespace
+
+// 参数为簿内委托笔数
+BENCHMARK(BM_PerEvent)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+BENCHMARK(BM_Batch)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -44,7 +44,8 @@ logic2() {
         --parallel 4 \
         --target install
 
-    export LD_LIBRARY_PATH=./install/lib:$LD_LIBRARY_PATH; ./install/bin/main -o 1 -t 1 -s 2 --type zb
+    # 用法: ./install/bin/convert -k order -i order.csv -o order.bin
+    #       ./install/bin/main -o order.bin -t trade.bin -s 2 --type zb
 
 }
 
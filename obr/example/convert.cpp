@@ -0,0 +1,207 @@
+/**
+ * @file convert.cpp
+ * @brief one-time CSV -> binary record file converter
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * order csv: secid,timestamp,order_id,price,quantity,side,type
+ * trade csv: secid,timestamp,trade_id,price,quantity,side,bid_order_id,
+ *            ask_order_id,type
+ * snapshot csv: secid,timestamp,bp1..bp10,bv1..bv10,ap1..ap10,av1..av10
+ *
+ * price is in yuan (e.g. 10.01), side is 1/B for buy and 2/S for sell,
+ * order type is 0..4 (LIMIT, MARKET, IOC, FOK, OWN_BEST) and trade type is
+ * 0/F for a fill and 1/C for a cancel. Empty snapshot levels are 0. Lines
+ * not starting with a digit are skipped, an order type outside 0..4 stops
+ * the conversion with the line number.
+ */
+#include <boost/program_options.hpp>
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "record_file.h"
+
+namespace {
+
+struct Cursor {
+  const char* p;
+  const char* end;
+
+  void nextField() {
+    while (p != end && *p != ',' && *p != '\n') ++p;
+    if (p != end && *p == ',') ++p;
+  }
+
+  void nextLine() {
+    while (p != end && *p != '\n') ++p;
+    if (p != end) ++p;
+  }
+
+  template <typename T>
+  T integer() {
+    T value = 0;
+    p = std::from_chars(p, end, value).ptr;
+    nextField();
+    return value;
+  }
+
+  // 十进制元价格转为 0.0001 元整数，不经过浮点
+  int64_t price() {
+    int64_t value = 0;
+    p = std::from_chars(p, end, value).ptr;
+    int64_t scale = 10000;
+    if (p != end && *p == '.') {
+      for (++p; p != end && *p >= '0' && *p <= '9' && scale > 1; ++p) {
+        scale /= 10;
+        value = value * 10 + (*p - '0');
+      }
+    }
+    nextField();
+    return value * scale;
+  }
+
+  // 0..4 依次为 LIMIT、MARKET、IOC、FOK、OWN_BEST，其他值不能转换成 OrderType
+  orderbook::OrderType orderType() {
+    unsigned value = 0;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() ||
+        value > static_cast<unsigned>(orderbook::OrderType::OWN_BEST)) {
+      throw std::invalid_argument("bad order type");
+    }
+    p = result.ptr;
+    nextField();
+    return static_cast<orderbook::OrderType>(value);
+  }
+
+  // 1/B 买，2/S 卖
+  bool isBuy() {
+    char c = p != end ? *p : '\0';
+    nextField();
+    return c != '2' && c != 'S';
+  }
+
+  // 0/F 成交，1/C 撤单
+  orderbook::TradeType tradeType() {
+    char c = p != end ? *p : '\0';
+    nextField();
+    return (c == '1' || c == 'C') ? orderbook::TradeType::CANCEL
+                                  : orderbook::TradeType::FILL;
+  }
+};
+
+template <typename Record, typename Parse>
+bool convert(const std::string& input, const std::string& output,
+             Parse parse) {
+  orderbook::MappedFile file(input);
+  std::vector<Record> records;
+  records.reserve(file.size() / 48);
+  Cursor cursor{file.data(), file.data() + file.size()};
+  for (uint64_t line = 1; cursor.p != cursor.end; ++line) {
+    if (*cursor.p >= '0' && *cursor.p <= '9') {
+      try {
+        records.push_back(parse(cursor));
+      } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(input + ":" + std::to_string(line) + ": " +
+                                 e.what());
+      }
+    }
+    cursor.nextLine();
+  }
+  std::cout << "records: " << records.size() << std::endl;
+  return orderbook::writeRecordFile(output, records.data(), records.size());
+}
+
+orderbook::Order parseOrder(Cursor& c) {
+  orderbook::Order record{};
+  record.secid = c.integer<uint32_t>();
+  record.timestamp = c.integer<uint64_t>();
+  record.order_id = c.integer<uint64_t>();
+  record.price = c.price();
+  record.quantity = c.integer<uint32_t>();
+  record.is_buy = c.isBuy();
+  record.type = c.orderType();
+  return record;
+}
+
+orderbook::Trade parseTrade(Cursor& c) {
+  orderbook::Trade record{};
+  record.secid = c.integer<uint32_t>();
+  record.timestamp = c.integer<uint64_t>();
+  record.trade_id = c.integer<uint64_t>();
+  record.price = c.price();
+  record.quantity = c.integer<uint32_t>();
+  record.aggressive_side = c.isBuy();
+  record.bid_order_id = c.integer<uint64_t>();
+  record.ask_order_id = c.integer<uint64_t>();
+  record.type = c.tradeType();
+  return record;
+}
+
+orderbook::MarketSnapshot parseSnapshot(Cursor& c) {
+  orderbook::MarketSnapshot record{};
+  record.secid = c.integer<uint32_t>();
+  record.timestamp = c.integer<uint64_t>();
+  for (auto& price : record.bidPrice) price = c.price();
+  for (auto& quantity : record.bidQuantity) quantity = c.integer<uint64_t>();
+  for (auto& price : record.askPrice) price = c.price();
+  for (auto& quantity : record.askQuantity) quantity = c.integer<uint64_t>();
+  return record;
+}
+
+bool convertKind(const std::string& kind, const std::string& input,
+                 const std::string& output) {
+  if (kind == "order") {
+    return convert<orderbook::Order>(input, output, parseOrder);
+  }
+  if (kind == "trade") {
+    return convert<orderbook::Trade>(input, output, parseTrade);
+  }
+  return convert<orderbook::MarketSnapshot>(input, output, parseSnapshot);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string kind;
+  std::string input;
+  std::string output;
+
+  namespace po = boost::program_options;
+  po::options_description desc("Allowed options");
+  desc.add_options()("kind,k", po::value<std::string>(&kind)->required(),
+                     "Record kind (order, trade or snapshot)")(
+      "input,i", po::value<std::string>(&input)->required(),
+      "CSV input path (required)")(
+      "output,o", po::value<std::string>(&output)->required(),
+      "Binary output path (required)");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (kind != "order" && kind != "trade" && kind != "snapshot") {
+      throw std::invalid_argument(
+          "Invalid kind: must be 'order', 'trade' or 'snapshot'");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n\n";
+    std::cerr << desc << std::endl;
+    return 1;
+  }
+
+  try {
+    if (!convertKind(kind, input, output)) {
+      std::cerr << "Error: cannot write " << output << std::endl;
+      return 1;
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -9,42 +9,128 @@
  * 
  */
 #include <boost/program_options.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "checkpoint.h"
+#include "parallel_replay.h"
 #include "reconstructor.h"
+#include "record_file.h"
+#include "snapshot.h"
+#include "verifier.h"
 
-template <typename T, size_t N>
-bool compareArrays(const T (&a)[N], const T (&b)[N]) {
-  for (size_t i = 0; i < N; ++i) {
-    if (a[i] != b[i]) return false;
+// 每只证券一行：secid,委托数,成交数,买一,卖一,集合竞价状态
+void writeSnapshots(std::ostream& out,
+                    const std::vector<orderbook::SecuritySnapshot>& snapshots) {
+  out << "secid,orders,trades,best_bid,best_ask,nts,cvl,cto,lpr";
+  for (const char* name : {"bp", "bs", "ap", "as"}) {
+    for (int i = 1; i <= 5; ++i) out << ',' << name << i;
   }
-  return true;
+  out << '\n';
+  for (const auto& snapshot : snapshots) {
+    const orderbook::OrderBookStatus& status = snapshot.status;
+    out << snapshot.secid << ',' << snapshot.orders << ',' << snapshot.trades
+        << ',' << snapshot.bestBid << ',' << snapshot.bestAsk << ','
+        << status.nts << ',' << status.cvl << ',' << status.cto << ','
+        << status.lpr;
+    for (const int* level : {status.bp, status.bs, status.ap, status.as}) {
+      for (int i = 0; i < 5; ++i) out << ',' << level[i];
+    }
+    out << '\n';
+  }
+}
+
+// YYYYMMDDHHMMSSmmm 加 seconds 秒，不跨日
+uint64_t addSeconds(uint64_t timestamp, unsigned seconds) {
+  uint64_t day = timestamp / 1000000000;
+  uint64_t time = timestamp % 1000000000;
+  uint64_t ms = time / 10000000 * 3600000 + time / 100000 % 100 * 60000 +
+                time % 100000;
+  ms = std::min<uint64_t>(ms + seconds * 1000ULL, 86399999);
+  return day * 1000000000 + ms / 3600000 * 10000000 +
+         ms / 60000 % 60 * 100000 + ms % 60000;
 }
 
-#define COMPARE_MEMBER(name) \
-  if (name != rhs.name) return false;
-
-struct Trade {
-  uint64_t id;       // Trade ID
-  uint64_t orderId;  // Order ID
-  uint64_t price;    // Trade price
-  uint64_t volume;   // Trade volume
-  uint32_t bp[5];
-  uint32_t ap[5];
-  bool operator==(const Trade& rhs) const {
-    COMPARE_MEMBER(id);
-    COMPARE_MEMBER(orderId);
-    COMPARE_MEMBER(price);
-    COMPARE_MEMBER(volume);
-    if (!compareArrays(bp, rhs.bp)) return false;
-    if (!compareArrays(ap, rhs.ap)) return false;
-    return true;
+// 逐段重放全部证券，每段结束写一次检查点；restore 非空时从检查点继续
+std::vector<orderbook::SecuritySnapshot> replaySession(
+    const orderbook::OrderFile& orders, const orderbook::TradeFile& trades,
+    orderbook::MarketType type, bool matching, unsigned threads,
+    const std::string& restore, const std::string& checkpoint,
+    unsigned every) {
+  std::unique_ptr<orderbook::ReplaySession> session;
+  if (restore.empty()) {
+    session = std::make_unique<orderbook::ReplaySession>(orders, trades, type,
+                                                         matching);
+  } else {
+    auto start = std::chrono::steady_clock::now();
+    session = std::make_unique<orderbook::ReplaySession>(
+        orders, trades, type, orderbook::CheckpointImage(restore), threads,
+        matching);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Restored " << restore << " at " << session->position()
+              << " in "
+              << std::chrono::duration<double, std::milli>(elapsed).count()
+              << " ms" << std::endl;
+  }
+  while (!session->done()) {
+    uint64_t until = checkpoint.empty()
+                         ? UINT64_MAX
+                         : addSeconds(session->pending(), every);
+    session->advance(until, threads);
+    if (!checkpoint.empty() && !session->checkpoint(checkpoint)) {
+      throw std::runtime_error("cannot write " + checkpoint);
+    }
   }
-};
+  return session->snapshots();
+}
+
+// 打印第一处偏差及其前后档位，返回偏差证券数
+size_t reportDivergences(std::ostream& out,
+                         const std::vector<orderbook::VerifyResult>& results) {
+  size_t diverged = 0;
+  uint64_t snapshots = 0;
+  for (const auto& result : results) {
+    snapshots += result.snapshots;
+    if (!result.diverged) continue;
+    ++diverged;
+    const orderbook::Divergence& d = result.divergence;
+    const orderbook::MarketSnapshot& e = d.exchange;
+    const orderbook::MarketSnapshot& r = d.reconstructed;
+    out << "secid " << result.secid << " diverged at " << e.timestamp
+        << " (snapshot " << d.snapshot << ", after " << d.events
+        << " events): " << d.field << '[' << d.level << "] expected "
+        << d.expected << ", got " << d.actual << '\n';
+    size_t first = d.level > 3 ? d.level - 3 : 0;
+    size_t last = std::min<size_t>(d.level + 2, e.kDepth);
+    auto level = [&out](int64_t price, uint64_t quantity) {
+      out << std::setw(10) << price << " x " << std::left << std::setw(8)
+          << quantity << std::right;
+    };
+    out << "  level" << std::left << std::setw(42) << "  exchange bid / ask"
+        << " |  reconstructed bid / ask\n" << std::right;
+    for (size_t i = first; i < last; ++i) {
+      out << "  " << std::setw(5) << i + 1;
+      level(e.bidPrice[i], e.bidQuantity[i]);
+      level(e.askPrice[i], e.askQuantity[i]);
+      out << " |";
+      level(r.bidPrice[i], r.bidQuantity[i]);
+      level(r.askPrice[i], r.askQuantity[i]);
+      out << '\n';
+    }
+  }
+  out << "Verified " << results.size() << " securities, " << snapshots
+      << " snapshots, " << diverged << " diverged" << std::endl;
+  return diverged;
+}
 
 int main(int argc, char* argv[]) {
   // 定义存储参数的变量
@@ -52,6 +138,13 @@ int main(int argc, char* argv[]) {
   std::string trade_file;
   unsigned int secid;
   std::string type;
+  unsigned int threads;
+  unsigned int depth;
+  std::string snapshot_file;
+  std::string verify_file;
+  std::string checkpoint_file;
+  unsigned int checkpoint_every;
+  std::string restore_file;
 
   namespace po = boost::program_options;
 
@@ -62,9 +155,27 @@ int main(int argc, char* argv[]) {
                      "Order file path (required)")(
       "trade_file,t", po::value<std::string>(&trade_file)->required(),
       "Trade file path (required)")("secid,s",
-                                    po::value<unsigned int>(&secid)->required(),
-                                    "Security ID (required)")(
-      "type", po::value<std::string>(&type)->required(), "Type (cyb or zb)");
+                                    po::value<unsigned int>(&secid),
+                                    "Security ID, all securities if omitted")(
+      "type", po::value<std::string>(&type)->required(), "Type (cyb or zb)")(
+      "threads,j", po::value<unsigned int>(&threads)->default_value(0),
+      "Worker threads for all securities, 0 for one per core")(
+      "match", "Match orders in the book instead of following trade records")(
+      "depth,d", po::value<unsigned int>(&depth)->default_value(0),
+      "Publish change-only depth snapshots (5/10/50) for --secid, 0 disables")(
+      "snapshot_file", po::value<std::string>(&snapshot_file),
+      "Per-security snapshot csv for all securities (default stdout), or "
+      "binary depth snapshots with --secid and --depth")(
+      "verify", po::value<std::string>(&verify_file),
+      "Compare against exchange snapshots (convert -k snapshot) and report "
+      "the first divergence of each security")(
+      "checkpoint", po::value<std::string>(&checkpoint_file),
+      "Checkpoint image rewritten while replaying all securities")(
+      "checkpoint_every",
+      po::value<unsigned int>(&checkpoint_every)->default_value(60),
+      "Market-time seconds between checkpoints")(
+      "restore", po::value<std::string>(&restore_file),
+      "Resume all securities from a checkpoint image of the same files");
 
   // 2. 解析命令行参数
   po::variables_map vm;
@@ -90,7 +201,8 @@ int main(int argc, char* argv[]) {
   // 4. 使用解析后的参数（示例输出）
   std::cout << "Order File: " << order_file << "\n"
             << "Trade File: " << trade_file << "\n"
-            << "SecID: " << secid << "\n"
+            << "SecID: " << (vm.count("secid") ? std::to_string(secid) : "all")
+            << "\n"
             << "Type: " << type << std::endl;
   orderbook::MarketType marketType = orderbook::MarketType::UNKNOWN;
   if (type == "cyb") {
@@ -101,15 +213,113 @@ int main(int argc, char* argv[]) {
     std::cerr << "Invalid type specified" << std::endl;
   }
   // 创建订单簿重建器
-  auto reconstructor = orderbook::createReconstructor(marketType);
+  auto reconstructor =
+      orderbook::createReconstructor(marketType, vm.count("match") != 0);
   if (!reconstructor) {
     std::cerr << "Failed to create reconstructor for specified market type"
               << std::endl;
     return 1;
   }
 
-  reconstructor->processOrder(orderbook::Order{});
-  reconstructor->processTrade(orderbook::Trade{});
+  try {
+    // order_file/trade_file 为 convert 生成的二进制文件
+    orderbook::OrderFile orders(order_file);
+    orderbook::TradeFile trades(trade_file);
+
+    if (!verify_file.empty()) {
+      orderbook::SnapshotFile expected(verify_file);
+      auto results =
+          orderbook::verifyAll(orders, trades, expected, marketType, threads,
+                               vm.count("match") != 0);
+      if (vm.count("secid")) {
+        std::vector<orderbook::VerifyResult> selected;
+        for (const auto& result : results) {
+          if (result.secid == secid) selected.push_back(result);
+        }
+        results.swap(selected);
+      }
+      return reportDivergences(std::cout, results) == 0 ? 0 : 2;
+    }
+
+    if (!vm.count("secid")) {
+      auto start = std::chrono::steady_clock::now();
+      auto snapshots =
+          checkpoint_file.empty() && restore_file.empty()
+              ? orderbook::replayAll(orders, trades, marketType, threads,
+                                     vm.count("match") != 0)
+              : replaySession(orders, trades, marketType,
+                              vm.count("match") != 0, threads, restore_file,
+                              checkpoint_file, checkpoint_every);
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "Securities: " << snapshots.size() << ", Replayed "
+                << orders.size() + trades.size() << " records in "
+                << std::chrono::duration<double, std::milli>(elapsed).count()
+                << " ms" << std::endl;
+      if (snapshot_file.empty()) {
+        writeSnapshots(std::cout, snapshots);
+      } else {
+        std::ofstream out(snapshot_file);
+        writeSnapshots(out, snapshots);
+        if (!out) {
+          throw std::runtime_error("cannot write " + snapshot_file);
+        }
+      }
+      return 0;
+    }
+
+    auto orderRange = orders.select(secid);
+    auto tradeRange = trades.select(secid);
+
+    // 快照由消费线程从环形队列取出写文件，回放线程不做任何 IO
+    orderbook::SnapshotRing ring(depth, 1 << 14);
+    orderbook::SnapshotPublisher publisher(ring, secid);
+    std::atomic<bool> replayed{false};
+    uint64_t consumed = 0;
+    std::thread consumer;
+    if (depth != 0) {
+      publisher.attach(*reconstructor, 1);
+      std::FILE* out = snapshot_file.empty()
+                           ? nullptr
+                           : std::fopen(snapshot_file.c_str(), "wb");
+      consumer = std::thread([&ring, &replayed, &consumed, out] {
+        size_t frameSize = orderbook::BookSnapshot::frameSize(ring.depth());
+        for (;;) {
+          bool finished = replayed.load(std::memory_order_acquire);
+          const orderbook::BookSnapshot* snapshot = ring.peek();
+          if (snapshot == nullptr) {
+            if (finished) break;
+            std::this_thread::yield();
+            continue;
+          }
+          if (out != nullptr) std::fwrite(snapshot, frameSize, 1, out);
+          ++consumed;
+          ring.release();
+        }
+        if (out != nullptr) std::fclose(out);
+      });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t count = orderbook::replay(*reconstructor, orderRange, tradeRange);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    replayed.store(true, std::memory_order_release);
+    if (consumer.joinable()) {
+      consumer.join();
+      std::cout << "Snapshots: " << consumed
+                << ", Dropped: " << publisher.dropped() << "\n";
+    }
+
+    std::cout << "Orders: " << orderRange.size()
+              << ", Trades: " << tradeRange.size() << ", Replayed " << count
+              << " records in "
+              << std::chrono::duration<double, std::milli>(elapsed).count()
+              << " ms\n";
+    std::cout << "Best Bid: " << reconstructor->book().bestBid()
+              << ", Best Ask: " << reconstructor->book().bestAsk() << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+/**
+ * @file call_auction.h
+ * @brief incremental call-auction (集合竞价) engine on a tick-indexed grid
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief tick-indexed price grid, index i <-> price base + i * tick
+ *
+ * prices are integers in units of 0.0001 yuan, so a 0.01 yuan tick is 100
+ */
+struct PriceGrid {
+  int64_t base = 0;
+  int64_t tick = 100;
+  uint32_t levels = 0;
+
+  bool empty() const { return levels == 0; }
+  bool contains(int64_t price) const {
+    return price >= base && price < limit() && (price - base) % tick == 0;
+  }
+  int64_t limit() const { return base + static_cast<int64_t>(levels) * tick; }
+  uint32_t index(int64_t price) const {
+    return static_cast<uint32_t>((price - base) / tick);
+  }
+  int64_t price(uint32_t index) const {
+    return base + static_cast<int64_t>(index) * tick;
+  }
+
+  /**
+   * @brief grid covering price * (100 ± percent) / 100
+   */
+  static PriceGrid around(int64_t price, int64_t tick, int percent);
+
+  /**
+   * @brief smallest grid containing both this grid and price
+   * the span is at least doubled so that repeated extensions stay amortized
+   */
+  PriceGrid extendTo(int64_t price) const;
+};
+
+/**
+ * @brief binary indexed tree of non-negative quantities
+ */
+class FenwickTree {
+ public:
+  explicit FenwickTree(size_t size = 0) { reset(size); }
+
+  void reset(size_t size);
+  size_t size() const { return tree_.size() - 1; }
+  uint64_t total() const { return total_; }
+
+  void add(size_t index, int64_t delta);
+
+  /**
+   * @brief sum of [0, index], index may be -1
+   */
+  uint64_t prefix(int64_t index) const;
+
+  /**
+   * @brief smallest index with prefix(index) >= target, size() if none
+   * target must be positive
+   */
+  size_t lowerBound(uint64_t target) const;
+
+ private:
+  std::vector<uint64_t> tree_;
+  size_t mask_ = 0;
+  uint64_t total_ = 0;
+};
+
+struct OptimPriceInfo {
+  int64_t dealPrice;
+  int64_t expectedDealQuantity;
+  int64_t buyAboveQuantity;
+  int64_t askBelowQuantity;
+  int64_t buyDealPriceLeftQuantity;
+  int64_t askDealPriceRightQuantity;
+
+  bool operator>(const OptimPriceInfo& other) const;
+};
+
+/**
+ * @brief cumulative bid/ask volume per price, O(log n) update and query
+ *
+ * B(i) = bid volume priced >= grid.price(i), S(i) = ask volume priced <=
+ * grid.price(i). The equilibrium is the candidate maximizing min(B, S) with
+ * the same validity, tie-breaking and scan order as the full recompute in
+ * MapOrderBook::flushStatus, so the results are identical.
+ */
+class CallAuction {
+ public:
+  explicit CallAuction(PriceGrid grid = {}) { reset(grid); }
+
+  void reset(PriceGrid grid);
+  const PriceGrid& grid() const { return grid_; }
+
+  /**
+   * @brief change resting quantity at price, price must be on the grid
+   */
+  void add(bool isBuy, int64_t price, int64_t delta);
+
+  uint64_t bidQuantity(uint32_t index) const { return bidQty_[index]; }
+  uint64_t askQuantity(uint32_t index) const { return askQty_[index]; }
+  uint64_t totalBid() const { return bids_.total(); }
+  uint64_t totalAsk() const { return asks_.total(); }
+
+  /**
+   * @brief best bid/ask grid index, only valid on a non-empty side
+   */
+  uint32_t bestBid() const;
+  uint32_t bestAsk() const;
+
+  /**
+   * @brief both sides non-empty and best bid >= best ask
+   */
+  bool crossed() const;
+
+  /**
+   * @brief volume executed by a price-time walk of the crossed book
+   * equals max over prices of min(B, S), 0 if not crossed
+   */
+  uint64_t matchedVolume() const;
+
+  /**
+   * @brief equilibrium price info, expectedDealQuantity is -1 if not crossed
+   */
+  OptimPriceInfo equilibrium() const;
+
+  /**
+   * @brief grid index of the bid/ask level still holding volume after
+   * `volume` units were matched, -1 if that side is exhausted
+   */
+  int64_t bidLevelAfter(uint64_t volume) const;
+  int64_t askLevelAfter(uint64_t volume) const;
+
+ private:
+  uint64_t cumBid(uint32_t index) const {
+    return bids_.total() - bids_.prefix(static_cast<int64_t>(index) - 1);
+  }
+  uint64_t cumAsk(uint32_t index) const { return asks_.prefix(index); }
+
+  /**
+   * @brief fold the equilibrium of levels [lo, hi] into best, the window is
+   * laid out contiguously and handed to searchEquilibrium
+   */
+  void scan(int64_t lo, int64_t hi, OptimPriceInfo& best) const;
+
+  PriceGrid grid_;
+  FenwickTree bids_;
+  FenwickTree asks_;
+  std::vector<uint64_t> bidQty_;
+  std::vector<uint64_t> askQty_;
+  mutable std::vector<uint64_t> cumBuy_;   // scan 窗口内的 B(i)
+  mutable std::vector<uint64_t> cumSell_;  // scan 窗口内的 S(i)
+};
+
+}  // namespace orderbook
@@ -0,0 +1,113 @@
+/**
+ * @file checkpoint.h
+ * @brief binary image of every security's book and replay position
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "order_pool.h"
+#include "reconstructor.h"
+#include "record_file.h"
+
+namespace orderbook {
+
+/**
+ * 文件布局（小端，与内存布局一致，映射后直接使用）:
+ *   CheckpointHeader
+ *   CheckpointEntry[securityCount]  按 secid 升序
+ *   BookOrder[orderCount]           每只证券的挂单及暂存委托，连续存放
+ */
+struct CheckpointHeader {
+  char magic[8];  // "OBRCHKPT"
+  uint32_t version;
+  uint8_t marketType;  // MarketType，恢复时须与重建器一致
+  uint8_t matching;
+  uint16_t reserved;
+  uint64_t timestamp;  // 所有证券都已重放到这一时刻（含）
+  uint64_t orderRecords;  // 生成时委托文件的记录数，用于校验
+  uint64_t tradeRecords;  // 生成时成交文件的记录数
+  uint64_t securityCount;
+  uint64_t orderCount;
+};
+
+struct CheckpointEntry {
+  uint32_t secid;
+  uint32_t reserved;
+  uint64_t ordersApplied;  // 该证券已重放的委托记录数
+  uint64_t tradesApplied;  // 该证券已重放的成交记录数
+  uint64_t first;          // 第一笔 BookOrder 的下标
+  ReconstructorState state;
+};
+
+static_assert(sizeof(CheckpointHeader) == 56, "packed header");
+static_assert(sizeof(BookOrder) == 32, "packed order");
+
+/**
+ * @brief collects the state of each security, then writes the image
+ */
+class CheckpointWriter {
+ public:
+  void add(uint32_t secid, uint64_t ordersApplied, uint64_t tradesApplied,
+           const OrderBookReconstructor& reconstructor);
+
+  /**
+   * @brief write to path + ".tmp", fsync it, rename over path and fsync the
+   * directory, so a crash at any point leaves either the previous or the new
+   * checkpoint intact
+   * @return false if the image cannot be written
+   */
+  bool write(const std::string& path, uint64_t timestamp, MarketType type,
+             bool matching, uint64_t orderRecords,
+             uint64_t tradeRecords) const;
+
+ private:
+  std::vector<CheckpointEntry> entries_;
+  std::vector<BookOrder> orders_;
+};
+
+/**
+ * @brief validated read-only mapping of a checkpoint image
+ */
+class CheckpointImage {
+ public:
+  /**
+   * @brief map and validate path, throws std::runtime_error on a bad image
+   */
+  explicit CheckpointImage(const std::string& path);
+
+  uint64_t timestamp() const { return header_->timestamp; }
+  MarketType marketType() const {
+    return static_cast<MarketType>(header_->marketType);
+  }
+  bool matching() const { return header_->matching != 0; }
+  uint64_t orderRecords() const { return header_->orderRecords; }
+  uint64_t tradeRecords() const { return header_->tradeRecords; }
+
+  RecordRange<CheckpointEntry> securities() const {
+    return {entries_, entries_ + header_->securityCount};
+  }
+
+  /**
+   * @brief put reconstructor into the state saved in entry
+   */
+  void restore(const CheckpointEntry& entry,
+               OrderBookReconstructor& reconstructor) const {
+    reconstructor.restoreState(entry.state, orders_ + entry.first);
+  }
+
+ private:
+  MappedFile file_;
+  const CheckpointHeader* header_;
+  const CheckpointEntry* entries_;
+  const BookOrder* orders_;
+};
+
+}  // namespace orderbook
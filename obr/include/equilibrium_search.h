@@ -0,0 +1,52 @@
+/**
+ * @file equilibrium_search.h
+ * @brief vectorized call-auction equilibrium search over contiguous levels
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace orderbook {
+
+/**
+ * @brief a window of consecutive grid levels, lowest price first
+ *
+ * cumBid[i] is the bid volume priced at or above level i and cumAsk[i] the
+ * ask volume priced at or below it, both including level i itself.
+ */
+struct AuctionLevels {
+  const uint64_t* bidQty;
+  const uint64_t* askQty;
+  const uint64_t* cumBid;
+  const uint64_t* cumAsk;
+  size_t size;
+};
+
+/**
+ * @brief level of the equilibrium price within levels, size if none is valid
+ *
+ * Picks the valid level with the largest executable volume min(B, S), then
+ * the smallest imbalance, exactly as OptimPriceInfo::operator> does. Ties
+ * resolve like the scalar scan that visits bid levels from high to low and
+ * then ask levels from low to high, keeping the first best: the highest tied
+ * level holding bids, otherwise the lowest tied level.
+ *
+ * Dispatches to the AVX2 kernel when the cpu supports it.
+ */
+size_t searchEquilibrium(const AuctionLevels& levels);
+
+size_t searchEquilibriumScalar(const AuctionLevels& levels);
+
+/**
+ * @brief AVX2 kernel, falls back to the scalar one where AVX2 is unavailable
+ */
+size_t searchEquilibriumAvx2(const AuctionLevels& levels);
+
+bool hasAvx2();
+
+}  // namespace orderbook
@@ -0,0 +1,142 @@
+/**
+ * @file flat_hash_map.h
+ * @brief open-addressing hash map keyed by uint64_t
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief linear probing over one contiguous slot array
+ *
+ * UINT64_MAX is reserved as the empty key. Erase shifts the following
+ * cluster back instead of leaving tombstones, so probe lengths do not
+ * degrade under heavy insert/erase churn (cancel-heavy order flow).
+ */
+template <typename Value>
+class FlatHashMap {
+ public:
+  static constexpr uint64_t kEmpty = UINT64_MAX;
+
+  explicit FlatHashMap(size_t count = 0) { reserve(count); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief make room for count keys without rehashing
+   */
+  void reserve(size_t count) {
+    size_t capacity = 16;
+    while (capacity * 3 < count * 4) {
+      capacity <<= 1;
+    }
+    if (capacity > slots_.size()) {
+      rehash(capacity);
+    }
+  }
+
+  void clear() {
+    for (auto& slot : slots_) {
+      slot.key = kEmpty;
+    }
+    size_ = 0;
+  }
+
+  Value* find(uint64_t key) {
+    for (size_t i = home(key);; i = (i + 1) & mask_) {
+      if (slots_[i].key == key) return &slots_[i].value;
+      if (slots_[i].key == kEmpty) return nullptr;
+    }
+  }
+
+  const Value* find(uint64_t key) const {
+    return const_cast<FlatHashMap*>(this)->find(key);
+  }
+
+  /**
+   * @brief pull the home slot of key into cache ahead of a find
+   */
+  void prefetch(uint64_t key) const {
+    __builtin_prefetch(&slots_[home(key)]);
+  }
+
+  /**
+   * @brief insert or overwrite, returns true if the key was new
+   */
+  bool insert(uint64_t key, const Value& value) {
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+      rehash(slots_.size() * 2);
+    }
+    size_t i = home(key);
+    for (; slots_[i].key != kEmpty; i = (i + 1) & mask_) {
+      if (slots_[i].key == key) {
+        slots_[i].value = value;
+        return false;
+      }
+    }
+    slots_[i].key = key;
+    slots_[i].value = value;
+    ++size_;
+    return true;
+  }
+
+  bool erase(uint64_t key) {
+    size_t i = home(key);
+    for (; slots_[i].key != key; i = (i + 1) & mask_) {
+      if (slots_[i].key == kEmpty) return false;
+    }
+    // 后移删除：把探测链上后续的元素前移填补空位
+    for (size_t j = (i + 1) & mask_; slots_[j].key != kEmpty;
+         j = (j + 1) & mask_) {
+      size_t k = home(slots_[j].key);
+      bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+      if (movable) {
+        slots_[i] = slots_[j];
+        i = j;
+      }
+    }
+    slots_[i].key = kEmpty;
+    --size_;
+    return true;
+  }
+
+ private:
+  struct Slot {
+    uint64_t key;
+    Value value;
+  };
+
+  size_t home(uint64_t key) const {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<size_t>(key) & mask_;
+  }
+
+  void rehash(size_t capacity) {
+    std::vector<Slot> slots(capacity, Slot{kEmpty, Value{}});
+    slots.swap(slots_);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for (const auto& slot : slots) {
+      if (slot.key != kEmpty) {
+        insert(slot.key, slot.value);
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t mask_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,343 @@
+/**
+ * @file full_order.h
+ * @brief full-depth order book with call-auction status
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "call_auction.h"
+#include "flat_hash_map.h"
+#include "order_pool.h"
+#include "price_ladder.h"
+#include "trading_phase.h"
+#include "types.h"
+
+namespace orderbook {
+
+struct OrderBookStatus {
+  uint64_t nts;
+  int64_t cvl;
+  int64_t cto;
+  int64_t lpr;
+
+  int bp[5];
+  int ap[5];
+  int bs[5];
+  int as[5];
+
+  void printInfo() const;
+};
+
+/**
+ * @brief aggregated quantity at one visible price
+ */
+struct DepthLevel {
+  int64_t price;
+  uint64_t quantity;
+
+  bool operator==(const DepthLevel& other) const {
+    return price == other.price && quantity == other.quantity;
+  }
+};
+
+/**
+ * @brief one match between a buy and a sell order
+ */
+struct Execution {
+  uint64_t buyId;
+  uint64_t sellId;
+  int64_t price;
+  uint64_t quantity;
+};
+
+/**
+ * @brief position of the order-by-order auction pairing on one side
+ */
+struct AuctionCursor {
+  int64_t level;    // PriceLadder::kNone 表示该侧已配对完
+  uint32_t order;   // 当前委托在本档队列中的序号
+  uint64_t filled;  // 本档已配对的数量
+};
+
+/**
+ * @brief pairing state at the point where either side entered a new level
+ */
+struct AuctionCheckpoint {
+  AuctionCursor bid;
+  AuctionCursor ask;
+  uint64_t trades;
+};
+
+/**
+ * @brief order book on two tick-indexed ladders sharing one price grid
+ * order nodes live in a pool and are queued per level in time priority,
+ * an order id index maps every resting order to its node so cancels and
+ * fills never search a level
+ */
+class OrderBook {
+ public:
+  /**
+   * @brief book on a tick grid, an empty grid is sized from the first order
+   * and the grid is extended whenever an order falls outside of it
+   * @param expectedOrders resting orders to preallocate the pool and the id
+   * index for, e.g. the day's expected order count
+   */
+  explicit OrderBook(PriceGrid grid = {}, size_t expectedOrders = 0);
+
+  /**
+   * @brief start a new trading day on the current grid: every order is
+   * dropped but the node slabs, the id index and the ladders keep their
+   * memory
+   */
+  void reset();
+
+  /**
+   * @brief append every resting order to orders: bid levels then ask levels,
+   * each from low to high price and in queue order within a level
+   */
+  void exportOrders(std::vector<BookOrder>& orders) const;
+
+  /**
+   * @brief replace the book with count orders laid out as by exportOrders,
+   * on grid and in phase, queue priority is preserved
+   */
+  void restore(PriceGrid grid, TradingPhase phase, const BookOrder* orders,
+               size_t count);
+
+  /**
+   * @brief auction status as of the last refreshStatus
+   */
+  const OrderBookStatus& status() const { return status_; }
+
+  /**
+   * @brief add a resting order, orders without quantity and ids that are
+   * already resting are ignored
+   * @return pool node of the order, OrderPool::kNull if ignored
+   */
+  uint32_t addOrder(const BookOrder& order);
+
+  /**
+   * @brief remove a resting order
+   * @return false if id is not resting
+   */
+  bool cancelOrder(uint64_t id);
+
+  /**
+   * @brief execute quantity against a resting order, removing it once it
+   * is fully filled
+   * @return false if id is not resting
+   */
+  bool fillOrder(uint64_t id, uint64_t quantity);
+
+  /**
+   * @brief matching mode: apply order at timestamp under the phase rules
+   *
+   * The book first advances to the phase of timestamp. In a call auction
+   * limit orders rest without matching and other types are rejected. In
+   * continuous trading the order matches against the opposite side in
+   * price-time priority at the resting prices:
+   *   LIMIT   up to its price, the remainder rests
+   *   MARKET  counterparty-best: limited to the best opposite price at entry,
+   *           the remainder rests there, rejected if that side is empty
+   *   OWN_BEST own-side best: a limit order at the best price of its own
+   *           side at entry, rejected if that side is empty
+   *   IOC     up to its price (any price if 0), the remainder is cancelled
+   *   FOK     like IOC but only if it can be filled completely
+   * Outside trading hours orders are rejected.
+   *
+   * @param executions matches are appended here
+   * @return quantity executed
+   */
+  uint64_t submitOrder(const BookOrder& order, OrderType type,
+                       uint64_t timestamp, std::vector<Execution>& executions);
+
+  /**
+   * @brief move to the phase of timestamp, leaving a call auction uncrosses
+   * the book at the equilibrium price
+   */
+  void advance(uint64_t timestamp, std::vector<Execution>& executions);
+
+  TradingPhase phase() const { return phase_; }
+  const PriceGrid& grid() const { return auction_.grid(); }
+
+  /**
+   * @brief execute every crossing order at the auction equilibrium price in
+   * price-time priority, the book is no longer crossed afterwards
+   */
+  void uncross(std::vector<Execution>& executions);
+
+  /**
+   * @brief resting order with id, nullptr if there is none
+   */
+  const BookOrder* findOrder(uint64_t id) const {
+    const uint32_t* node = index_.find(id);
+    return node == nullptr ? nullptr : &pool_[*node].order;
+  }
+
+  size_t orderCount() const { return index_.size(); }
+
+  const BookOrder& order(uint32_t node) const { return pool_[node].order; }
+
+  /**
+   * @brief pull the id index slot of id into cache
+   */
+  void prefetchOrder(uint64_t id) const { index_.prefetch(id); }
+
+  /**
+   * @brief pull the price level an order at price would join into cache
+   */
+  void prefetchLevel(bool isBuy, int64_t price) const {
+    (isBuy ? bids_ : asks_).prefetch(price);
+  }
+
+  /**
+   * @brief best bid/ask price, 0 if that side is empty
+   */
+  int64_t bestBid() const;
+  int64_t bestAsk() const;
+
+  /**
+   * @brief auction status computed from the incremental auction engine
+   */
+  OrderBookStatus auctionStatus() const;
+
+  /**
+   * @brief best count levels of one side, best first
+   * @return number of levels written, less than count if the side is thinner
+   */
+  size_t depth(bool isBuy, DepthLevel* levels, size_t count) const;
+
+  /**
+   * @brief like depth, but of the book left after a virtual uncross at the
+   * auction equilibrium: the levels the exchange publishes during a call
+   * auction. Equal to depth when the book is not crossed.
+   */
+  size_t residualDepth(bool isBuy, DepthLevel* levels, size_t count) const;
+
+  /**
+   * @brief recompute status() from auctionStatus()
+   */
+  const OrderBookStatus& refreshStatus() {
+    status_ = auctionStatus();
+    return status_;
+  }
+
+  /**
+   * @brief add the order, then refresh and print the status
+   */
+  void insertOrder(const BookOrder& order);
+
+  void printOrderBook() const;
+
+  const PriceLadder& bids() const { return bids_; }
+  const PriceLadder& asks() const { return asks_; }
+  const OrderPool& pool() const { return pool_; }
+
+ private:
+  void removeNode(uint32_t node);
+  /**
+   * @return true if the node was fully filled and released
+   */
+  bool fillNode(uint32_t node, uint64_t quantity);
+  /**
+   * @brief quantity resting on side isBuy at prices no worse than limit
+   * for the taker, stopping once need is reached
+   */
+  uint64_t available(bool isBuy, int64_t limit, uint64_t need) const;
+  uint64_t match(BookOrder& taker, int64_t limit,
+                 std::vector<Execution>& executions);
+  void extendGrid(int64_t price);
+  /**
+   * @brief residualDepth of a crossed book at a known equilibrium
+   */
+  size_t residualLevels(bool isBuy, const OptimPriceInfo& optimPriceInfo,
+                        uint64_t matched, DepthLevel* levels,
+                        size_t count) const;
+
+  /**
+   * @brief number of order-by-order matches in the crossed region
+   *
+   * Pairing follows price-time priority on both sides. Whole levels that fit
+   * in the current order of the other side are counted from their order
+   * count. Within a level, the run of orders that fits in the current order
+   * of the other side is found by a binary search over the level's
+   * cumulative quantities, so each step ends one order of the other side
+   * however many small orders it absorbs. The cumulative quantities of a
+   * level are kept across calls, an append extends them and any other change
+   * rebuilds them when the level is next paired.
+   *
+   * The walk resumes from the last checkpoint taken before the best level
+   * touched since the previous call. A change at the best price shifts which
+   * slice of the other side every later order pairs with, so it is paired
+   * again from the start: the cost is one step per switch between the sides,
+   * linear in the crossed orders only when orders on both sides are of
+   * similar size.
+   */
+  uint64_t countAuctionTrades() const;
+
+  /**
+   * @brief a level at price changed, pairing has to be redone from there
+   * @param appended quantity of an order appended to the level, 0 for any
+   * other change
+   */
+  void touchLevel(bool isBuy, int64_t price, uint64_t appended = 0) {
+    int64_t index = auction_.grid().index(price);
+    std::vector<std::vector<uint64_t>>& cuts = isBuy ? bidCuts_ : askCuts_;
+    if (isBuy) {
+      touchedBid_ = std::max(touchedBid_, index);
+    } else {
+      touchedAsk_ = std::min(touchedAsk_, index);
+    }
+    if (static_cast<size_t>(index) >= cuts.size() || cuts[index].empty()) {
+      return;
+    }
+    if (appended != 0) {
+      cuts[index].push_back(cuts[index].back() + appended);
+    } else {
+      cuts[index].clear();
+    }
+  }
+
+  /**
+   * @brief level indexes changed, drop every checkpoint
+   */
+  void touchAll() {
+    checkpoints_.clear();
+    for (std::vector<uint64_t>& cuts : bidCuts_) {
+      cuts.clear();
+    }
+    for (std::vector<uint64_t>& cuts : askCuts_) {
+      cuts.clear();
+    }
+    touchedBid_ = INT64_MAX;
+    touchedAsk_ = PriceLadder::kNone;
+  }
+
+  OrderPool pool_;
+  FlatHashMap<uint32_t> index_;  // order id -> pool node
+  PriceLadder bids_;
+  PriceLadder asks_;
+  CallAuction auction_;
+  OrderBookStatus status_{};
+  TradingPhase phase_ = TradingPhase::CLOSED;
+
+  // nts 的配对检查点与结果，auctionStatus 为 const，按需重算
+  mutable std::vector<AuctionCheckpoint> checkpoints_;
+  mutable uint64_t auctionTrades_ = 0;
+  // 上次配对以来改动过的最高买价位与最低卖价位
+  mutable int64_t touchedBid_ = INT64_MAX;
+  mutable int64_t touchedAsk_ = PriceLadder::kNone;
+  // 按档位下标，本档各委托的累计数量，空表示需要重建
+  mutable std::vector<std::vector<uint64_t>> bidCuts_;
+  mutable std::vector<std::vector<uint64_t>> askCuts_;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,61 @@
+/**
+ * @file gem_reconstructor.h
+ * @brief ChiNext (创业板) reconstructor with price-cage (价格笼子) rules
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <functional>
+#include <map>
+
+#include "main_board_reconstructor.h"
+
+namespace orderbook {
+
+/**
+ * @brief during continuous trading a limit buy priced above
+ * max(102% of the buy benchmark, benchmark + 10 ticks) or a limit sell priced
+ * below min(98% of the sell benchmark, benchmark - 10 ticks) is held outside
+ * the book and enters it once the benchmark moves enough.
+ *
+ * buy benchmark: best ask, else best bid, else last trade price
+ * sell benchmark: best bid, else best ask, else last trade price
+ */
+class GemReconstructor final : public MainBoardReconstructor {
+ public:
+  static constexpr int64_t kTick = 100;  // 0.01 元
+
+  using MainBoardReconstructor::MainBoardReconstructor;
+
+  void processOrder(const Order& order) override;
+  void processTrade(const Trade& trade) override;
+  size_t processEvents(const Event* events, size_t count) override;
+
+  ReconstructorState saveState(std::vector<BookOrder>& orders) const override;
+  void restoreState(const ReconstructorState& state,
+                    const BookOrder* orders) override;
+
+  size_t cagedCount() const { return caged_.size(); }
+
+ private:
+  bool withinCage(const BookOrder& order) const;
+  void cage(const BookOrder& order);
+  bool uncage(uint64_t id);
+
+  /**
+   * @brief move caged orders that became eligible into the book,
+   * everything is released outside continuous trading
+   */
+  void releaseCaged(uint64_t timestamp);
+
+  FlatHashMap<BookOrder> caged_;
+  // 暂存订单按最先满足入簿条件的顺序排列：买单价格升序、卖单价格降序，
+  // 同价位按时间先后
+  std::multimap<int64_t, uint64_t> cagedBuys_;
+  std::multimap<int64_t, uint64_t, std::greater<>> cagedSells_;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,118 @@
+/**
+ * @file live_feed.h
+ * @brief decode decompressed exchange blocks into events and keep one live
+ * book per security
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * A block is a run of SZSE binary messages, all integers big endian:
+ *
+ *   uint32 MsgType, uint32 BodyLength, body, uint32 Checksum
+ *
+ * Only tick-by-tick orders (300192) and executions (300191) are decoded,
+ * every other message type is skipped by its BodyLength. Prices are N13(4)
+ * and already in 0.0001 yuan, quantities are N15(2) and divided by 100. The
+ * checksum is not verified, the transport below has its own CRC.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "flat_hash_map.h"
+#include "reconstructor.h"
+#include "types.h"
+
+namespace orderbook {
+
+constexpr uint32_t kFeedOrderMsgType = 300192;  // 逐笔委托
+constexpr uint32_t kFeedTradeMsgType = 300191;  // 逐笔成交
+
+/**
+ * @brief board of an SZSE security by code: 30xxxx is ChiNext (创业板),
+ * everything else (00xxxx main board, funds, bonds) follows main board rules
+ */
+inline MarketType szseMarketOf(uint32_t secid) {
+  return secid / 10000 == 30 ? MarketType::GEM : MarketType::MAIN_BOARD;
+}
+
+/**
+ * @brief stateless decoder for one decompressed block
+ */
+class FeedDecoder {
+ public:
+  /**
+   * @param data block, no alignment needed
+   * @param out receives at most capacity events
+   * @param consumed bytes of data decoded, less than size if out filled up
+   * or the block ends in a truncated message
+   * @return number of events written
+   */
+  static size_t decode(const char* data, size_t size, Event* out,
+                       size_t capacity, size_t& consumed);
+};
+
+/**
+ * @brief live books of every security seen on a feed
+ *
+ * Reconstructors are created empty on a security's first event and grow
+ * with their resting orders. Events decoded
+ * from a block are applied in place from a fixed batch, consecutive events
+ * of the same security go to processEvents together. Not thread safe, one
+ * instance per receiving thread.
+ */
+class LiveFeed {
+ public:
+  /**
+   * @brief called once for every new security, e.g. to attach a snapshot
+   * handler before its first event
+   */
+  using SecurityHandler =
+      std::function<void(uint32_t secid, OrderBookReconstructor&)>;
+
+  /**
+   * @param type reconstructor of every security, UNKNOWN picks it per
+   * security with szseMarketOf
+   */
+  explicit LiveFeed(MarketType type = MarketType::UNKNOWN,
+                    bool matching = false);
+
+  void setSecurityHandler(SecurityHandler handler) {
+    securityHandler_ = std::move(handler);
+  }
+
+  /**
+   * @brief apply every order and trade of a decompressed block
+   * @return number of events applied
+   */
+  size_t onBlock(const char* data, size_t size);
+
+  /**
+   * @return nullptr if secid has not been seen yet
+   */
+  const OrderBookReconstructor* find(uint32_t secid) const;
+
+  size_t securities() const { return reconstructors_.size(); }
+  uint64_t events() const { return events_; }
+
+  // 以截断消息结尾的块数
+  uint64_t truncatedBlocks() const { return truncatedBlocks_; }
+
+ private:
+  // 首次出现的证券在此创建重建器
+  OrderBookReconstructor& reconstructorOf(uint32_t secid);
+
+  MarketType type_;
+  bool matching_;
+  FlatHashMap<uint32_t> index_;  // secid -> reconstructors_ 下标
+  std::vector<std::unique_ptr<OrderBookReconstructor>> reconstructors_;
+  SecurityHandler securityHandler_;
+  uint64_t events_ = 0;
+  uint64_t truncatedBlocks_ = 0;
+};
+
+}  // namespace orderbook
@@ -9,39 +9,74 @@
  * 
  */
 #pragma once
+#include <vector>
+
+#include "full_order.h"
 #include "reconstructor.h"
-#include <map>
 namespace orderbook {
 
 class MainBoardReconstructor : public OrderBookReconstructor {
  public:
-  MainBoardReconstructor();
+  /**
+   * @param matching false: the book follows the exchange's trade records;
+   * true: the book matches orders itself (OrderBook::submitOrder) and trade
+   * records only contribute cancels
+   * @param expectedOrders orders to preallocate the book for, e.g. the
+   * security's record count, 0 starts empty and grows on demand
+   */
+  explicit MainBoardReconstructor(bool matching = false,
+                                  size_t expectedOrders = 0);
   ~MainBoardReconstructor() override;
 
   /**
    * @brief process order
-   * what can I say
+   * without matching, limit orders rest at their price, market orders rest
+   * at the best opposite price, own-best orders at the best price of their
+   * own side, IOC/FOK orders never rest and only show up in trades
    * @param order 
    */
-  virtual void processOrder(Order order) override;
+  virtual void processOrder(const Order& order) override;
 
   /**
    * @brief trade process
-   * 
+   * a fill reduces both referenced orders, a cancel removes the cancelled one
    * @param trade from file
    */
-  virtual void processTrade(Trade trade) override;
-private:
+  virtual void processTrade(const Trade& trade) override;
+
+  size_t processEvents(const Event* events, size_t count) override;
+
+  void prefetch(const Event& event) const override;
+
+  const OrderBook& book() const override { return book_; }
+
+  ReconstructorState saveState(std::vector<BookOrder>& orders) const override;
+  void restoreState(const ReconstructorState& state,
+                    const BookOrder* orders) override;
+
+  /**
+   * @brief executions produced by the last event in matching mode
+   */
+  const std::vector<Execution>& executions() const { return executions_; }
+
+ protected:
+  /**
+   * @brief put order into the book under the reconstruction mode
+   */
+  void enter(BookOrder order, OrderType type, uint64_t timestamp);
+
+  bool matching_;
+  std::vector<Execution> executions_;
   /**
-   * @brief order book map
+   * @brief order book
    * 
    */
-  std::map<std::string, Order> order_book_;
+  OrderBook book_;
   /**
-   * @brief trade vector
+   * @brief last trade price
    * 
    */
-  std::vector<Trade> trades_;
+  int64_t lastPrice_ = 0;
 };
 
-}  // namespace orderbook
\ No newline at end of file
+}  // namespace orderbook
@@ -0,0 +1,108 @@
+/**
+ * @file map_order_book.h
+ * @brief std::map / std::list order book with full status recompute
+ *
+ * the original book representation, kept as the reference implementation
+ * for OrderBook and as the baseline for benchmarks
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+
+#include "full_order.h"
+
+namespace orderbook {
+
+struct ConfigurableComparator {
+  bool is_ascending;
+  explicit ConfigurableComparator(bool asc) : is_ascending(asc) {}
+
+  bool operator()(uint64_t a, uint64_t b) const {
+    return is_ascending ? (a < b) : (a > b);
+  }
+};
+
+struct PriceLevel {
+  uint64_t quantity;
+  std::list<BookOrder> orders;
+};
+
+using OrderBookMap = std::map<uint64_t, PriceLevel, ConfigurableComparator>;
+
+class OrderIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = BookOrder;
+  using difference_type = std::ptrdiff_t;
+  using pointer = BookOrder*;
+  using reference = BookOrder&;
+
+  OrderIterator() = default;
+
+  explicit OrderIterator(OrderBookMap& price_map, bool is_end = false);
+
+  reference operator*() { return *list_iter; }
+  pointer operator->() { return &(*list_iter); }
+
+  OrderIterator& operator++();
+  OrderIterator operator++(int) {
+    OrderIterator tmp = *this;
+    ++(*this);
+    return tmp;
+  }
+
+  OrderBookMap::iterator getMapIter() const { return map_iter; }
+
+  bool operator==(const OrderIterator& other) const {
+    if (map_iter != other.map_iter) return false;
+    if (map_iter == map_end) return true;
+    return list_iter == other.list_iter;
+  }
+  bool operator!=(const OrderIterator& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  // 辅助函数：前进到有效位置
+  void advance_to_valid();
+
+  OrderBookMap::iterator map_iter;
+  OrderBookMap::iterator map_end;
+  std::list<BookOrder>::iterator list_iter;
+};
+
+class MapOrderBook {
+ public:
+  /**
+   * @brief full recompute of the auction status from every resting order
+   */
+  OrderBookStatus flushStatus();
+
+  void addOrder(const BookOrder& order);
+
+  /**
+   * @brief remove order id, scanning every level of both sides
+   * @return false if id is not resting
+   */
+  bool cancelOrder(uint64_t id);
+
+  /**
+   * @brief add the order, then recompute and print the status
+   */
+  void insertOrder(const BookOrder& order);
+
+  void printOrderBook() const;
+
+ private:
+  OrderBookMap askPriceMaps{ConfigurableComparator(true)};
+  OrderBookMap bidPriceMaps{ConfigurableComparator(false)};
+};
+
+}  // namespace orderbook
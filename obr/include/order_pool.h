@@ -0,0 +1,109 @@
+/**
+ * @file order_pool.h
+ * @brief pooled intrusive order nodes
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace orderbook {
+
+struct BookOrder {
+  uint64_t id;
+  int64_t price;
+  uint64_t quantity;
+  int8_t side;  // 1 for buy, 2 for sell
+};
+
+/**
+ * @brief resting order linked into its price level queue by node index
+ */
+struct OrderNode {
+  BookOrder order;
+  uint32_t prev;
+  uint32_t next;
+};
+
+/**
+ * @brief slab arena of order nodes addressed by uint32_t handle
+ *
+ * Nodes are carved from fixed slabs of kSlabSize that never move, so an
+ * opening-auction burst costs one allocation per slab instead of a malloc
+ * per order or a reallocation copying every live node. Released nodes go on
+ * a free list and are reused first. reset() forgets every node for the next
+ * trading day but keeps the slabs, so a warmed-up book stops allocating.
+ */
+class OrderPool {
+ public:
+  static constexpr uint32_t kNull = UINT32_MAX;
+  // 65536 个 40 字节节点，约 2.5 MiB 一块：过小的块在 glibc 下会反复 mmap/trim，每只证券都重新缺页
+  static constexpr uint32_t kSlabBits = 16;
+  static constexpr uint32_t kSlabSize = 1u << kSlabBits;
+
+  void reserve(size_t count) {
+    while (capacity() < count) {
+      addSlab();
+    }
+  }
+
+  /**
+   * @brief drop every node and keep the slabs for reuse
+   */
+  void reset() {
+    used_ = 0;
+    freeHead_ = kNull;
+  }
+
+  /**
+   * @brief drop every node and free the slabs
+   */
+  void clear() {
+    slabs_.clear();
+    reset();
+  }
+
+  size_t capacity() const { return slabs_.size() << kSlabBits; }
+
+  uint32_t allocate(const BookOrder& order) {
+    uint32_t node = freeHead_;
+    if (node != kNull) {
+      freeHead_ = (*this)[node].next;
+    } else {
+      if (used_ == capacity()) {
+        addSlab();
+      }
+      node = used_++;
+    }
+    (*this)[node] = OrderNode{order, kNull, kNull};
+    return node;
+  }
+
+  void release(uint32_t node) {
+    (*this)[node].next = freeHead_;
+    freeHead_ = node;
+  }
+
+  OrderNode& operator[](uint32_t node) {
+    return slabs_[node >> kSlabBits][node & (kSlabSize - 1)];
+  }
+  const OrderNode& operator[](uint32_t node) const {
+    return slabs_[node >> kSlabBits][node & (kSlabSize - 1)];
+  }
+
+ private:
+  // 不做值初始化，页面在首次分配节点时才被触及
+  void addSlab() { slabs_.emplace_back(new OrderNode[kSlabSize]); }
+
+  std::vector<std::unique_ptr<OrderNode[]>> slabs_;
+  uint32_t used_ = 0;  // 已切出的节点数，之后的节点从未使用过
+  uint32_t freeHead_ = kNull;
+};
+
+}  // namespace orderbook
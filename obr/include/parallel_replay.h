@@ -0,0 +1,134 @@
+/**
+ * @file parallel_replay.h
+ * @brief replay every security of a day across a pool of worker threads
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+#include "full_order.h"
+#include "reconstructor.h"
+#include "record_file.h"
+#include "types.h"
+
+namespace orderbook {
+
+/**
+ * @brief book state of one security at the end of its replay
+ */
+struct SecuritySnapshot {
+  uint32_t secid;
+  uint64_t orders;
+  uint64_t trades;
+  int64_t bestBid;
+  int64_t bestAsk;
+  OrderBookStatus status;
+};
+
+/**
+ * @brief run work(0) .. work(count - 1) on a pool of workers
+ *
+ * Indexes are handed out in order from an atomic cursor, so put the largest
+ * jobs first. Worker 0 is the calling thread and keeps its affinity, the
+ * spawned workers are pinned round-robin to the cpus in the process affinity
+ * mask.
+ *
+ * @param workers number of threads, 0 for the number of allowed cpus
+ */
+void parallelFor(size_t count, unsigned workers,
+                 const std::function<void(size_t)>& work);
+
+/**
+ * @brief replay all securities found in either file
+ *
+ * Securities are independent, so each one gets its own reconstructor and
+ * the only shared state is the job cursor. Jobs are handed out largest
+ * first so a few very active securities do not end up last on one core.
+ *
+ * @param workers number of threads, 0 for the number of allowed cpus
+ * @param matching passed on to createReconstructor
+ * @return one snapshot per security, in ascending secid order
+ */
+std::vector<SecuritySnapshot> replayAll(const OrderFile& orders,
+                                        const TradeFile& trades,
+                                        MarketType type, unsigned workers,
+                                        bool matching = false);
+
+/**
+ * @brief every security of a day replayed in step up to a moving timestamp,
+ * so the whole session can be checkpointed and resumed after a restart
+ *
+ * Every book is alive for the whole session, so books start empty and grow
+ * with their resting orders instead of being sized for the day's records.
+ */
+class ReplaySession {
+ public:
+  ReplaySession(const OrderFile& orders, const TradeFile& trades,
+                MarketType type, bool matching = false);
+
+  /**
+   * @brief continue from image, which must have been taken on the same files
+   * throws std::runtime_error if it was not
+   * @param workers threads rebuilding the books, 0 for the number of allowed cpus
+   */
+  ReplaySession(const OrderFile& orders, const TradeFile& trades,
+                MarketType type, const CheckpointImage& image,
+                unsigned workers, bool matching = false);
+
+  /**
+   * @brief replay every record with timestamp <= until
+   * @param workers number of threads, 0 for the number of allowed cpus
+   */
+  void advance(uint64_t until, unsigned workers);
+
+  /**
+   * @brief timestamp every security has been replayed up to
+   */
+  uint64_t position() const { return position_; }
+
+  /**
+   * @brief earliest timestamp not replayed yet, UINT64_MAX once done
+   */
+  uint64_t pending() const;
+  bool done() const { return pending() == UINT64_MAX; }
+
+  /**
+   * @return false if the image cannot be written
+   */
+  bool checkpoint(const std::string& path) const;
+
+  /**
+   * @return one snapshot per security, in ascending secid order
+   */
+  std::vector<SecuritySnapshot> snapshots() const;
+
+ private:
+  struct Security {
+    uint32_t secid;
+    RecordRange<Order> orders;
+    RecordRange<Trade> trades;
+    uint64_t ordersApplied;
+    uint64_t tradesApplied;
+    std::unique_ptr<OrderBookReconstructor> reconstructor;
+  };
+
+  const OrderFile& orderFile_;
+  const TradeFile& tradeFile_;
+  MarketType type_;
+  bool matching_;
+  std::vector<Security> securities_;  // secid 升序
+  std::vector<size_t> schedule_;      // 按记录数从大到小
+  uint64_t position_ = 0;
+};
+
+}  // namespace orderbook
@@ -0,0 +1,206 @@
+/**
+ * @file price_ladder.h
+ * @brief contiguous tick-indexed price levels with a non-empty bitmap
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "call_auction.h"
+#include "order_pool.h"
+
+namespace orderbook {
+
+struct LadderLevel {
+  uint64_t quantity = 0;
+  uint32_t count = 0;
+  uint32_t head = OrderPool::kNull;
+  uint32_t tail = OrderPool::kNull;
+};
+
+/**
+ * @brief one side of the book, level i holds the orders priced grid.price(i)
+ *
+ * A two-level bitmap (one bit per level, one summary bit per 64 levels) finds
+ * the next non-empty level in a couple of bit scans, so best bid/ask and
+ * depth walks never touch empty levels.
+ */
+class PriceLadder {
+ public:
+  static constexpr int64_t kNone = -1;
+
+  void reset(PriceGrid grid);
+
+  /**
+   * @brief move every level onto grid, which must contain the current grid
+   */
+  void rebase(PriceGrid grid);
+
+  const PriceGrid& grid() const { return grid_; }
+  bool empty() const { return occupied_ == 0; }
+
+  const LadderLevel& level(uint32_t index) const { return levels_[index]; }
+
+  /**
+   * @brief pull the level of price into cache, no-op off the grid
+   */
+  void prefetch(int64_t price) const {
+    if (grid_.contains(price)) {
+      __builtin_prefetch(&levels_[grid_.index(price)]);
+    }
+  }
+
+  /**
+   * @brief append node to the back of its price level queue
+   */
+  void append(OrderPool& pool, uint32_t node);
+
+  /**
+   * @brief unlink node from its price level queue, the node is not released
+   */
+  void unlink(OrderPool& pool, uint32_t node);
+
+  /**
+   * @brief take quantity off a queued node, keeping its queue position
+   */
+  void reduce(OrderPool& pool, uint32_t node, uint64_t quantity) {
+    OrderNode& entry = pool[node];
+    entry.order.quantity -= quantity;
+    levels_[grid_.index(entry.order.price)].quantity -= quantity;
+  }
+
+  /**
+   * @brief lowest non-empty level >= index, kNone if none
+   */
+  int64_t atOrAbove(int64_t index) const;
+
+  /**
+   * @brief highest non-empty level <= index, kNone if none
+   */
+  int64_t atOrBelow(int64_t index) const;
+
+  int64_t lowest() const { return atOrAbove(0); }
+  int64_t highest() const { return atOrBelow(grid_.levels - 1); }
+
+ private:
+  void mark(uint32_t index) {
+    words_[index >> 6] |= 1ULL << (index & 63);
+    summary_[index >> 12] |= 1ULL << ((index >> 6) & 63);
+    ++occupied_;
+  }
+
+  void unmark(uint32_t index) {
+    uint64_t& word = words_[index >> 6];
+    word &= ~(1ULL << (index & 63));
+    if (word == 0) {
+      summary_[index >> 12] &= ~(1ULL << ((index >> 6) & 63));
+    }
+    --occupied_;
+  }
+
+  PriceGrid grid_;
+  std::vector<LadderLevel> levels_;
+  std::vector<uint64_t> words_;
+  std::vector<uint64_t> summary_;
+  uint32_t occupied_ = 0;
+};
+
+inline void PriceLadder::append(OrderPool& pool, uint32_t node) {
+  OrderNode& entry = pool[node];
+  uint32_t index = grid_.index(entry.order.price);
+  LadderLevel& level = levels_[index];
+  entry.prev = level.tail;
+  entry.next = OrderPool::kNull;
+  if (level.tail == OrderPool::kNull) {
+    level.head = node;
+    mark(index);
+  } else {
+    pool[level.tail].next = node;
+  }
+  level.tail = node;
+  level.quantity += entry.order.quantity;
+  ++level.count;
+}
+
+inline void PriceLadder::unlink(OrderPool& pool, uint32_t node) {
+  OrderNode& entry = pool[node];
+  uint32_t index = grid_.index(entry.order.price);
+  LadderLevel& level = levels_[index];
+  if (entry.prev == OrderPool::kNull) {
+    level.head = entry.next;
+  } else {
+    pool[entry.prev].next = entry.next;
+  }
+  if (entry.next == OrderPool::kNull) {
+    level.tail = entry.prev;
+  } else {
+    pool[entry.next].prev = entry.prev;
+  }
+  level.quantity -= entry.order.quantity;
+  if (--level.count == 0) {
+    unmark(index);
+  }
+}
+
+inline int64_t PriceLadder::atOrAbove(int64_t index) const {
+  if (index < 0) {
+    index = 0;
+  }
+  if (index >= grid_.levels) {
+    return kNone;
+  }
+  size_t word = static_cast<size_t>(index) >> 6;
+  uint64_t bits = words_[word] & (~0ULL << (index & 63));
+  if (bits != 0) {
+    return static_cast<int64_t>((word << 6) + __builtin_ctzll(bits));
+  }
+  size_t next = word + 1;
+  for (size_t s = next >> 6; s < summary_.size(); ++s) {
+    uint64_t summary = summary_[s];
+    if (s == (next >> 6)) {
+      summary &= (next & 63) ? ~0ULL << (next & 63) : ~0ULL;
+    }
+    if (summary != 0) {
+      word = (s << 6) + __builtin_ctzll(summary);
+      return static_cast<int64_t>((word << 6) + __builtin_ctzll(words_[word]));
+    }
+  }
+  return kNone;
+}
+
+inline int64_t PriceLadder::atOrBelow(int64_t index) const {
+  if (index >= grid_.levels) {
+    index = static_cast<int64_t>(grid_.levels) - 1;
+  }
+  if (index < 0) {
+    return kNone;
+  }
+  size_t word = static_cast<size_t>(index) >> 6;
+  uint64_t bits = words_[word] & (~0ULL >> (63 - (index & 63)));
+  if (bits != 0) {
+    return static_cast<int64_t>((word << 6) + 63 - __builtin_clzll(bits));
+  }
+  if (word == 0) {
+    return kNone;
+  }
+  size_t prev = word - 1;
+  for (size_t s = (prev >> 6) + 1; s-- > 0;) {
+    uint64_t summary = summary_[s];
+    if (s == (prev >> 6)) {
+      summary &= ~0ULL >> (63 - (prev & 63));
+    }
+    if (summary != 0) {
+      word = (s << 6) + 63 - __builtin_clzll(summary);
+      return static_cast<int64_t>((word << 6) + 63 -
+                                  __builtin_clzll(words_[word]));
+    }
+  }
+  return kNone;
+}
+
+}  // namespace orderbook
@@ -1,24 +1,136 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <memory>
-#include <string>
+#include <vector>
 
+#include "full_order.h"
 #include "types.h"
 
 namespace orderbook {
 
+/**
+ * @brief fixed part of a reconstructor's resumable state, stored verbatim in
+ * checkpoint images next to the orders it counts
+ */
+struct ReconstructorState {
+  PriceGrid grid;
+  int64_t lastPrice;
+  uint64_t resting;  // 订单簿中的挂单数
+  uint64_t parked;   // 重建器暂存、尚未进入订单簿的委托数（如价格笼子）
+  TradingPhase phase;
+  uint8_t reserved[7];
+};
+
 class OrderBookReconstructor {
  public:
+  /**
+   * @brief called with the book and the timestamp of the last event applied
+   */
+  using SnapshotHandler = std::function<void(const OrderBook&, uint64_t)>;
+
   virtual ~OrderBookReconstructor() = default;
 
   // 处理一个委托订单
-  virtual void processOrder(Order order) = 0;
+  virtual void processOrder(const Order& order) = 0;
 
   // 处理一笔交易
-  virtual void processTrade(Trade trade) = 0;
+  virtual void processTrade(const Trade& trade) = 0;
+
+  /**
+   * @brief process an interleaved run of events in one call
+   * the snapshot handler, if set, fires every snapshotEvery events and once
+   * at the end of the batch
+   * @return number of events processed
+   */
+  virtual size_t processEvents(const Event* events, size_t count);
+
+  /**
+   * @brief snapshot trigger for processEvents, everyEvents == 0 means only at
+   * batch boundaries, an empty handler disables snapshots
+   */
+  void setSnapshotHandler(SnapshotHandler handler, uint32_t everyEvents = 0) {
+    snapshotHandler_ = std::move(handler);
+    snapshotEvery_ = everyEvents;
+    untilSnapshot_ = everyEvents;
+  }
+
+  /**
+   * @brief hint that event will be processed soon, processEvents calls it
+   * kPrefetchDistance events ahead
+   */
+  virtual void prefetch(const Event&) const {}
+
+  // 当前重建出的订单簿
+  virtual const OrderBook& book() const = 0;
+
+  /**
+   * @brief append the orders needed to resume to orders, resting ones first
+   * @return the rest of the state
+   */
+  virtual ReconstructorState saveState(
+      std::vector<BookOrder>& orders) const = 0;
+
+  /**
+   * @brief continue from a saved state, orders points at its resting then
+   * its parked orders
+   */
+  virtual void restoreState(const ReconstructorState& state,
+                            const BookOrder* orders) = 0;
+
+ protected:
+  /**
+   * @brief apply events through Self's handlers without virtual dispatch
+   */
+  template <typename Self>
+  static size_t dispatchEvents(Self& self, const Event* events, size_t count);
+
+  /**
+   * @brief count one event towards the snapshot trigger
+   * @return true if the handler should fire now
+   */
+  bool snapshotDue() {
+    if (snapshotEvery_ == 0 || --untilSnapshot_ != 0) {
+      return false;
+    }
+    untilSnapshot_ = snapshotEvery_;
+    return static_cast<bool>(snapshotHandler_);
+  }
+
+  static constexpr size_t kPrefetchDistance = 8;
+
+  SnapshotHandler snapshotHandler_;
+  uint32_t snapshotEvery_ = 0;
+  uint32_t untilSnapshot_ = 0;
 };
 
-// 工厂函数：创建特定市场的订单簿重建器
-std::unique_ptr<OrderBookReconstructor> createReconstructor(MarketType type);
+template <typename Self>
+size_t OrderBookReconstructor::dispatchEvents(Self& self, const Event* events,
+                                              size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    if (i + kPrefetchDistance < count) {
+      self.Self::prefetch(events[i + kPrefetchDistance]);
+    }
+    const Event& event = events[i];
+    if (event.type == EventType::ORDER) {
+      self.Self::processOrder(event.order);
+    } else {
+      self.Self::processTrade(event.trade);
+    }
+    if (self.snapshotDue()) {
+      self.snapshotHandler_(self.book(), event.timestamp());
+    }
+  }
+  if (count != 0 && self.snapshotHandler_) {
+    self.snapshotHandler_(self.book(), events[count - 1].timestamp());
+  }
+  return count;
+}
+
+// 工厂函数：创建特定市场的订单簿重建器，matching 为 true 时由订单簿自行撮合，
+// expectedOrders 为预分配的委托笔数，0 表示按需增长
+std::unique_ptr<OrderBookReconstructor> createReconstructor(
+    MarketType type, bool matching = false, size_t expectedOrders = 0);
 
-}  // namespace orderbook
\ No newline at end of file
+}  // namespace orderbook
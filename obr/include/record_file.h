@@ -0,0 +1,175 @@
+/**
+ * @file record_file.h
+ * @brief fixed-width binary order/trade files, read through mmap
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * File layout (little endian):
+ *   RecordFileHeader
+ *   SecurityIndex[securityCount]   按 secid 升序
+ *   Order/Trade/MarketSnapshot[recordCount]  按 (secid, timestamp) 排序
+ *
+ * The index maps every secid to one contiguous run of records, so replaying
+ * a single security touches only its own pages. Records have the in-memory
+ * Order/Trade layout, so nothing is parsed: replay copies them straight into
+ * Event batches. Every index entry is checked against recordCount on open.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+namespace orderbook {
+
+class OrderBookReconstructor;
+
+struct RecordFileHeader {
+  char magic[8];  // "OBRORDER" / "OBRTRADE"
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t recordCount;
+  uint64_t securityCount;
+};
+
+struct SecurityIndex {
+  uint32_t secid;
+  uint32_t reserved;
+  uint64_t first;  // 第一条记录的下标
+  uint64_t count;
+};
+
+static_assert(sizeof(RecordFileHeader) == 32, "packed header");
+static_assert(sizeof(SecurityIndex) == 24, "packed index");
+
+/**
+ * @brief read-only private mapping of a whole file
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief map path, throws std::runtime_error if it cannot be opened
+   */
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  /**
+   * @brief ask the kernel to read [offset, offset + length) ahead
+   */
+  void willNeed(size_t offset, size_t length) const;
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+template <typename Record>
+struct RecordRange {
+  const Record* first = nullptr;
+  const Record* last = nullptr;
+
+  const Record* begin() const { return first; }
+  const Record* end() const { return last; }
+  size_t size() const { return static_cast<size_t>(last - first); }
+  bool empty() const { return first == last; }
+};
+
+/**
+ * @brief validated view over a mapped Order / Trade record file
+ */
+template <typename Record>
+class RecordFile {
+ public:
+  /**
+   * @brief map and validate path, throws std::runtime_error on a bad file
+   */
+  explicit RecordFile(const std::string& path);
+
+  uint64_t size() const { return header_->recordCount; }
+  RecordRange<Record> all() const { return {records_, records_ + size()}; }
+
+  /**
+   * @brief index entries in ascending secid order
+   */
+  RecordRange<SecurityIndex> securities() const {
+    return {index_, index_ + header_->securityCount};
+  }
+
+  /**
+   * @brief the records of one security, empty if it is not in the file
+   */
+  RecordRange<Record> select(uint32_t secid) const;
+
+ private:
+  MappedFile file_;
+  const RecordFileHeader* header_;
+  const SecurityIndex* index_;
+  const Record* records_;
+};
+
+extern template class RecordFile<Order>;
+extern template class RecordFile<Trade>;
+extern template class RecordFile<MarketSnapshot>;
+
+using OrderFile = RecordFile<Order>;
+using TradeFile = RecordFile<Trade>;
+using SnapshotFile = RecordFile<MarketSnapshot>;
+
+/**
+ * @brief write records as a record file, sorting them by (secid, timestamp)
+ * @return false if path cannot be written
+ */
+template <typename Record>
+bool writeRecordFile(const std::string& path, Record* records, size_t count);
+
+extern template bool writeRecordFile(const std::string&, Order*, size_t);
+extern template bool writeRecordFile(const std::string&, Trade*, size_t);
+extern template bool writeRecordFile(const std::string&, MarketSnapshot*,
+                                     size_t);
+
+/**
+ * @brief merges an order range and a trade range by timestamp, an order
+ * goes before a trade carrying the same timestamp
+ */
+class EventMerger {
+ public:
+  EventMerger(RecordRange<Order> orders, RecordRange<Trade> trades)
+      : order_(orders.begin()),
+        orderEnd_(orders.end()),
+        trade_(trades.begin()),
+        tradeEnd_(trades.end()) {}
+
+  bool done() const { return order_ == orderEnd_ && trade_ == tradeEnd_; }
+
+  /**
+   * @brief copy up to capacity next events with timestamp <= until into out
+   * @return number of events written
+   */
+  size_t next(Event* out, size_t capacity, uint64_t until = UINT64_MAX);
+
+ private:
+  const Order* order_;
+  const Order* orderEnd_;
+  const Trade* trade_;
+  const Trade* tradeEnd_;
+};
+
+/**
+ * @brief feed orders and trades to reconstructor in timestamp order,
+ * an order goes before a trade carrying the same timestamp, events are
+ * handed over through processEvents in batches of 256
+ * @return number of records replayed
+ */
+size_t replay(OrderBookReconstructor& reconstructor,
+              RecordRange<Order> orders, RecordRange<Trade> trades);
+
+}  // namespace orderbook
@@ -0,0 +1,149 @@
+/**
+ * @file snapshot.h
+ * @brief change-only depth snapshots published into a lock-free ring
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "full_order.h"
+
+namespace orderbook {
+
+class OrderBookReconstructor;
+
+/**
+ * @brief fixed header of one binary snapshot frame
+ * followed by depth bid levels then depth ask levels, unused levels are zero
+ */
+struct BookSnapshot {
+  uint64_t timestamp;  // 触发快照的最后一个事件的时间戳
+  uint64_t sequence;   // 每个发布者从 1 开始递增
+  uint32_t secid;
+  uint16_t depth;
+  uint16_t bidCount;
+  uint16_t askCount;
+  uint16_t reserved[3];
+
+  const DepthLevel* bids() const {
+    return reinterpret_cast<const DepthLevel*>(this + 1);
+  }
+  const DepthLevel* asks() const { return bids() + depth; }
+  DepthLevel* bids() { return reinterpret_cast<DepthLevel*>(this + 1); }
+  DepthLevel* asks() { return bids() + depth; }
+
+  static size_t frameSize(size_t depth) {
+    return sizeof(BookSnapshot) + 2 * depth * sizeof(DepthLevel);
+  }
+};
+
+static_assert(sizeof(BookSnapshot) == 32, "packed snapshot header");
+
+/**
+ * @brief single-producer single-consumer ring of equally sized frames
+ *
+ * The producer owns head_, the consumer owns tail_; each side only reads the
+ * other's counter when its cached copy says the ring looks full / empty, so
+ * the two cache lines are rarely shared.
+ */
+class SnapshotRing {
+ public:
+  /**
+   * @param depth levels per side of every frame
+   * @param capacity frames, rounded up to a power of two
+   */
+  SnapshotRing(size_t depth, size_t capacity);
+
+  size_t depth() const { return depth_; }
+  size_t capacity() const { return mask_ + 1; }
+
+  /**
+   * @brief producer: next free frame, nullptr if the ring is full
+   */
+  BookSnapshot* claim();
+
+  /**
+   * @brief producer: make the claimed frame visible to the consumer
+   */
+  void commit() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  /**
+   * @brief consumer: oldest unread frame, nullptr if the ring is empty
+   */
+  const BookSnapshot* peek();
+
+  /**
+   * @brief consumer: done with the frame returned by peek
+   */
+  void release() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+ private:
+  BookSnapshot* frame(uint64_t position) const {
+    return reinterpret_cast<BookSnapshot*>(
+        reinterpret_cast<char*>(frames_.get()) + (position & mask_) * stride_);
+  }
+
+  size_t depth_;
+  size_t stride_;  // 帧大小，按 8 字节对齐
+  size_t mask_;
+  std::unique_ptr<uint64_t[]> frames_;
+
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t cachedTail_ = 0;  // 生产者看到的 tail_
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  uint64_t cachedHead_ = 0;  // 消费者看到的 head_
+};
+
+/**
+ * @brief writes a frame into the ring only when the visible depth changed
+ *
+ * Levels come from OrderBook::residualDepth, so a crossed book during a
+ * call auction is published as it stands after the virtual uncross. The
+ * previous frame is kept locally, so an unchanged book costs one depth
+ * walk and a compare. A full ring drops the snapshot (counted in dropped())
+ * and the next publish retries, the producer never blocks.
+ */
+class SnapshotPublisher {
+ public:
+  SnapshotPublisher(SnapshotRing& ring, uint32_t secid);
+
+  /**
+   * @return true if a frame was written
+   */
+  bool publish(const OrderBook& book, uint64_t timestamp);
+
+  /**
+   * @brief publish from the reconstructor's snapshot trigger
+   * @param everyEvents see OrderBookReconstructor::setSnapshotHandler
+   */
+  void attach(OrderBookReconstructor& reconstructor, uint32_t everyEvents);
+
+  uint64_t published() const { return sequence_; }
+  uint64_t dropped() const { return dropped_; }
+
+ private:
+  SnapshotRing& ring_;
+  uint32_t secid_;
+  uint64_t sequence_ = 0;
+  uint64_t dropped_ = 0;
+  size_t bidCount_ = 0;
+  size_t askCount_ = 0;
+  std::vector<DepthLevel> last_;     // 上次发布的买卖档位
+  std::vector<DepthLevel> current_;  // 本次计算的买卖档位
+};
+
+}  // namespace orderbook
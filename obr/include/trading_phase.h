@@ -0,0 +1,50 @@
+/**
+ * @file trading_phase.h
+ * @brief SZSE trading session phases from event timestamps
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstdint>
+
+namespace orderbook {
+
+enum class TradingPhase : uint8_t {
+  CLOSED,
+  OPENING_AUCTION,  // 开盘集合竞价
+  CONTINUOUS,       // 连续竞价
+  CLOSING_AUCTION,  // 收盘集合竞价
+};
+
+/**
+ * @brief phase at a YYYYMMDDHHMMSSmmm timestamp
+ *
+ * 09:15-09:25 opening auction, 09:25-14:57 continuous, 14:57-15:00 closing
+ * auction. Orders entered 09:25-09:30 are held by the exchange and then
+ * matched in arrival order at 09:30, which replays the same as matching
+ * them on arrival, so that window counts as continuous. No orders arrive in
+ * the 11:30-13:00 break, so it is not a phase of its own either.
+ */
+inline TradingPhase phaseAt(uint64_t timestamp) {
+  uint64_t time = timestamp % 1000000000;
+  if (time < 91500000 || time >= 150000000) {
+    return TradingPhase::CLOSED;
+  }
+  if (time < 92500000) {
+    return TradingPhase::OPENING_AUCTION;
+  }
+  if (time < 145700000) {
+    return TradingPhase::CONTINUOUS;
+  }
+  return TradingPhase::CLOSING_AUCTION;
+}
+
+inline bool isAuction(TradingPhase phase) {
+  return phase == TradingPhase::OPENING_AUCTION ||
+         phase == TradingPhase::CLOSING_AUCTION;
+}
+
+}  // namespace orderbook
@@ -1,7 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
-#include <string>
-#include <vector>
+#include <type_traits>
 
 namespace orderbook {
 enum class MarketType {
@@ -10,27 +10,105 @@ enum class MarketType {
   GEM,         // 创业板
 };
 
-enum class OrderType {
+enum class OrderType : uint8_t {
   LIMIT,
-  MARKET,
+  MARKET,    // 对手方最优
   IOC,
   FOK,
+  OWN_BEST,  // 本方最优
 };
 
+/**
+ * @brief one order event, prices are integers in 0.0001 yuan
+ * fixed size and trivially copyable, record files and feeds hold these as is
+ */
 struct Order {
-  uint64_t timestamp;
-  std::string order_id;
-  double price;
+  uint64_t timestamp;  // YYYYMMDDHHMMSSmmm
+  uint64_t order_id;
+  int64_t price;
+  uint32_t secid;
   uint32_t quantity;
   bool is_buy;     // true for bid, false for ask
   OrderType type;  // LIMIT, MARKET, etc.
 };
 
+enum class TradeType : uint8_t {
+  FILL,    // 成交
+  CANCEL,  // 撤单，只有被撤一方的委托号有效
+};
+
 struct Trade {
-  uint64_t timestamp;
-  std::string trade_id;
-  double price;
+  uint64_t timestamp;  // YYYYMMDDHHMMSSmmm
+  uint64_t trade_id;
+  uint64_t bid_order_id;  // 0 if absent
+  uint64_t ask_order_id;  // 0 if absent
+  int64_t price;
+  uint32_t secid;
   uint32_t quantity;
   bool aggressive_side;  // true if buyer-initiated
+  TradeType type;
+};
+
+/**
+ * @brief exchange-published depth snapshot (行情快照), unused levels are zero
+ */
+struct MarketSnapshot {
+  static constexpr size_t kDepth = 10;
+
+  uint64_t timestamp;  // YYYYMMDDHHMMSSmmm
+  uint32_t secid;
+  uint32_t reserved;
+  int64_t bidPrice[kDepth];  // 买一在前
+  uint64_t bidQuantity[kDepth];
+  int64_t askPrice[kDepth];  // 卖一在前
+  uint64_t askQuantity[kDepth];
+};
+
+enum class EventType : uint8_t {
+  ORDER,
+  TRADE,
 };
+
+/**
+ * @brief one entry of an interleaved order/trade stream
+ */
+struct Event {
+  EventType type;
+  union {
+    Order order;
+    Trade trade;
+  };
+
+  static Event of(const Order& order) {
+    Event event;
+    event.type = EventType::ORDER;
+    event.order = order;
+    return event;
+  }
+
+  static Event of(const Trade& trade) {
+    Event event;
+    event.type = EventType::TRADE;
+    event.trade = trade;
+    return event;
+  }
+
+  uint64_t timestamp() const {
+    return type == EventType::ORDER ? order.timestamp : trade.timestamp;
+  }
+
+  uint32_t secid() const {
+    return type == EventType::ORDER ? order.secid : trade.secid;
+  }
+};
+
+static_assert(std::is_trivially_copyable_v<Order> && sizeof(Order) == 40,
+              "Order is a fixed-width record");
+static_assert(std::is_trivially_copyable_v<Trade> && sizeof(Trade) == 56,
+              "Trade is a fixed-width record");
+static_assert(std::is_trivially_copyable_v<MarketSnapshot> &&
+                  sizeof(MarketSnapshot) == 336,
+              "MarketSnapshot is a fixed-width record");
+static_assert(std::is_trivially_copyable_v<Event> && sizeof(Event) == 64,
+              "Event fills one cache line");
 }  // namespace orderbook
@@ -0,0 +1,84 @@
+/**
+ * @file verifier.h
+ * @brief replay against exchange depth snapshots and report the first
+ * divergence of every security
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "full_order.h"
+#include "record_file.h"
+#include "types.h"
+
+namespace orderbook {
+
+class OrderBookReconstructor;
+
+/**
+ * @brief first field where the reconstructed book differs from the exchange
+ */
+struct Divergence {
+  uint64_t snapshot;  // 该证券的第几个快照，从 0 开始
+  uint64_t events;    // 比较前已重放的事件数
+  const char* field;  // "bidPrice" / "bidQuantity" / "askPrice" / "askQuantity"
+  uint32_t level;     // 档位，从 1 开始
+  int64_t expected;   // 交易所
+  int64_t actual;     // 重建
+  MarketSnapshot exchange;
+  MarketSnapshot reconstructed;
+};
+
+/**
+ * @brief verification outcome of one security
+ */
+struct VerifyResult {
+  uint32_t secid;
+  uint64_t snapshots;  // 已比对的快照数
+  bool diverged;
+  Divergence divergence;  // diverged 为 true 时有效
+};
+
+/**
+ * @brief byte offset of the first difference, size if the blocks are equal
+ * compares 16 bytes per step with SSE2 where available
+ */
+size_t firstMismatch(const void* lhs, const void* rhs, size_t size);
+
+/**
+ * @brief top MarketSnapshot::kDepth levels of book in exchange layout
+ * a crossed book (call auction) is reported as its virtual-match residual,
+ * as the exchange does, see OrderBook::residualDepth
+ */
+MarketSnapshot captureSnapshot(const OrderBook& book, uint32_t secid,
+                               uint64_t timestamp);
+
+/**
+ * @brief apply every event up to each snapshot's timestamp, then compare
+ *
+ * Only the price / quantity arrays are compared; the replay stops at the
+ * first mismatch since everything after it is usually a consequence.
+ */
+VerifyResult verify(OrderBookReconstructor& reconstructor,
+                    RecordRange<Order> orders, RecordRange<Trade> trades,
+                    RecordRange<MarketSnapshot> snapshots);
+
+/**
+ * @brief verify every security of snapshots on a pool of workers
+ * @param workers number of threads, 0 for the number of allowed cpus
+ * @param matching passed on to createReconstructor
+ * @return one result per security in ascending secid order
+ */
+std::vector<VerifyResult> verifyAll(const OrderFile& orders,
+                                    const TradeFile& trades,
+                                    const SnapshotFile& snapshots,
+                                    MarketType type, unsigned workers,
+                                    bool matching = false);
+
+}  // namespace orderbook
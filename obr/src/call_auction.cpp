@@ -0,0 +1,230 @@
+#include "call_auction.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+#include "equilibrium_search.h"
+
+namespace orderbook {
+
+PriceGrid PriceGrid::around(int64_t price, int64_t tick, int percent) {
+  int64_t steps = price * percent / 100 / tick + 1;
+  PriceGrid grid;
+  grid.tick = tick;
+  grid.base = price - steps * tick;
+  if (grid.base < 0) {
+    grid.base = price % tick;
+  }
+  grid.levels = static_cast<uint32_t>((price - grid.base) / tick + steps + 1);
+  return grid;
+}
+
+PriceGrid PriceGrid::extendTo(int64_t price) const {
+  if (empty()) {
+    return around(price, tick, 20);
+  }
+  PriceGrid grid;
+  // 价格不在当前网格上时缩小 tick，保证已有价格仍然落在网格上
+  grid.tick = std::gcd(tick, std::abs(price - base));
+  int64_t span = limit() - base;
+  int64_t lo = base;
+  int64_t hi = limit() - tick;
+  if (price < base) {
+    lo = std::max<int64_t>(std::min(price, base - span), 0);
+  } else if (price > hi) {
+    hi = std::max(price, hi + span);
+  }
+  grid.base = base - (base - lo) / grid.tick * grid.tick;
+  grid.levels = static_cast<uint32_t>((hi - grid.base) / grid.tick + 1);
+  return grid;
+}
+
+void FenwickTree::reset(size_t size) {
+  tree_.assign(size + 1, 0);
+  total_ = 0;
+  mask_ = 1;
+  while (mask_ <= size) {
+    mask_ <<= 1;
+  }
+  mask_ >>= 1;
+}
+
+void FenwickTree::add(size_t index, int64_t delta) {
+  total_ += static_cast<uint64_t>(delta);
+  for (size_t i = index + 1; i < tree_.size(); i += i & (~i + 1)) {
+    tree_[i] += static_cast<uint64_t>(delta);
+  }
+}
+
+uint64_t FenwickTree::prefix(int64_t index) const {
+  uint64_t sum = 0;
+  for (size_t i = static_cast<size_t>(index + 1); i > 0; i &= i - 1) {
+    sum += tree_[i];
+  }
+  return sum;
+}
+
+size_t FenwickTree::lowerBound(uint64_t target) const {
+  size_t pos = 0;
+  for (size_t step = mask_; step > 0; step >>= 1) {
+    if (pos + step < tree_.size() && tree_[pos + step] < target) {
+      pos += step;
+      target -= tree_[pos];
+    }
+  }
+  return pos;
+}
+
+bool OptimPriceInfo::operator>(const OptimPriceInfo& other) const {
+  uint64_t quantityDiff = std::abs(buyAboveQuantity - askBelowQuantity);
+  uint64_t otherQuantityDiff =
+      std::abs(other.buyAboveQuantity - other.askBelowQuantity);
+  return expectedDealQuantity > other.expectedDealQuantity ||
+         (expectedDealQuantity == other.expectedDealQuantity &&
+          quantityDiff < otherQuantityDiff);
+}
+
+void CallAuction::reset(PriceGrid grid) {
+  grid_ = grid;
+  bids_.reset(grid.levels);
+  asks_.reset(grid.levels);
+  bidQty_.assign(grid.levels, 0);
+  askQty_.assign(grid.levels, 0);
+}
+
+void CallAuction::add(bool isBuy, int64_t price, int64_t delta) {
+  uint32_t index = grid_.index(price);
+  if (isBuy) {
+    bids_.add(index, delta);
+    bidQty_[index] += static_cast<uint64_t>(delta);
+  } else {
+    asks_.add(index, delta);
+    askQty_[index] += static_cast<uint64_t>(delta);
+  }
+}
+
+uint32_t CallAuction::bestBid() const {
+  return static_cast<uint32_t>(bids_.lowerBound(bids_.total()));
+}
+
+uint32_t CallAuction::bestAsk() const {
+  return static_cast<uint32_t>(asks_.lowerBound(1));
+}
+
+bool CallAuction::crossed() const {
+  return bids_.total() > 0 && asks_.total() > 0 && bestBid() >= bestAsk();
+}
+
+uint64_t CallAuction::matchedVolume() const {
+  if (!crossed()) {
+    return 0;
+  }
+  // B(i) - S(i) 单调不增，找到第一个 B(i) < S(i) 的位置
+  uint32_t lo = bestAsk();
+  uint32_t hi = bestBid() + 1;
+  uint32_t first = lo;
+  uint32_t last = hi;
+  while (first < last) {
+    uint32_t mid = first + (last - first) / 2;
+    if (cumBid(mid) >= cumAsk(mid)) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
+  uint64_t volume = first > lo ? cumAsk(first - 1) : 0;
+  if (first < hi) {
+    volume = std::max(volume, cumBid(first));
+  }
+  return volume;
+}
+
+OptimPriceInfo CallAuction::equilibrium() const {
+  OptimPriceInfo best{};
+  best.expectedDealQuantity = -1;
+  if (!crossed()) {
+    return best;
+  }
+  int64_t bestAskIndex = bestAsk();
+  int64_t bestBidIndex = bestBid();
+  uint64_t volume = matchedVolume();
+
+  // 所有成交量为 volume 的有效候选价都落在 [q - 1, r + 1] 内:
+  // q 为 B(i) <= volume 的最低价, r 为 S(i) <= volume 的最高价
+  int64_t q = 0;
+  if (bids_.total() > volume) {
+    q = static_cast<int64_t>(bids_.lowerBound(bids_.total() - volume)) + 1;
+  }
+  int64_t r = static_cast<int64_t>(asks_.lowerBound(volume + 1)) - 1;
+  scan(std::max(q - 1, bestAskIndex), std::min(r + 1, bestBidIndex), best);
+
+  if (best.expectedDealQuantity != static_cast<int64_t>(volume)) {
+    best = OptimPriceInfo{};
+    best.expectedDealQuantity = -1;
+    scan(bestAskIndex, bestBidIndex, best);
+  }
+  return best;
+}
+
+void CallAuction::scan(int64_t lo, int64_t hi, OptimPriceInfo& best) const {
+  if (lo > hi) {
+    return;
+  }
+  size_t size = static_cast<size_t>(hi - lo + 1);
+  cumBuy_.resize(size);
+  cumSell_.resize(size);
+  uint64_t cumBuy = cumBid(static_cast<uint32_t>(hi));
+  for (size_t i = size; i-- > 0;) {
+    cumBuy_[i] = cumBuy;
+    if (i > 0) {
+      cumBuy += bidQty_[lo + i - 1];
+    }
+  }
+  uint64_t cumSell = cumAsk(static_cast<uint32_t>(lo));
+  for (size_t i = 0; i < size; ++i) {
+    cumSell_[i] = cumSell;
+    if (i + 1 < size) {
+      cumSell += askQty_[lo + i + 1];
+    }
+  }
+
+  AuctionLevels levels{bidQty_.data() + lo, askQty_.data() + lo,
+                       cumBuy_.data(), cumSell_.data(), size};
+  size_t found = searchEquilibrium(levels);
+  if (found == size) {
+    return;
+  }
+  int64_t currBuy = levels.bidQty[found];
+  int64_t currSell = levels.askQty[found];
+  int64_t buyAboveQuantity = cumBuy_[found] - currBuy;
+  int64_t askBelowQuantity = cumSell_[found] - currSell;
+  int64_t expectedDealQuantity = std::min(buyAboveQuantity + currBuy,
+                                          askBelowQuantity + currSell);
+  OptimPriceInfo current{
+      grid_.price(static_cast<uint32_t>(lo + found)),
+      expectedDealQuantity,
+      buyAboveQuantity,
+      askBelowQuantity,
+      currBuy + buyAboveQuantity - expectedDealQuantity,
+      currSell + askBelowQuantity - expectedDealQuantity};
+  if (current > best) {
+    best = current;
+  }
+}
+
+int64_t CallAuction::bidLevelAfter(uint64_t volume) const {
+  if (volume >= bids_.total()) {
+    return -1;
+  }
+  return static_cast<int64_t>(bids_.lowerBound(bids_.total() - volume));
+}
+
+int64_t CallAuction::askLevelAfter(uint64_t volume) const {
+  if (volume >= asks_.total()) {
+    return -1;
+  }
+  return static_cast<int64_t>(asks_.lowerBound(volume + 1));
+}
+
+}  // namespace orderbook
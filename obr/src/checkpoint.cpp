@@ -0,0 +1,134 @@
+#include "checkpoint.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace orderbook {
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'B', 'R', 'C', 'H', 'K', 'P', 'T'};
+constexpr uint32_t kCheckpointVersion = 1;
+
+// rename 本身要落盘，还得同步所在目录
+bool syncDirectoryOf(const std::string& path) {
+  size_t slash = path.rfind('/');
+  std::string directory = slash == std::string::npos ? "."
+                          : slash == 0               ? "/"
+                                                     : path.substr(0, slash);
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = ::fsync(fd) == 0;
+  ::close(fd);
+  return ok;
+}
+
+}  // namespace
+
+void CheckpointWriter::add(uint32_t secid, uint64_t ordersApplied,
+                           uint64_t tradesApplied,
+                           const OrderBookReconstructor& reconstructor) {
+  size_t first = orders_.size();
+  ReconstructorState state = reconstructor.saveState(orders_);
+
+  // 结构体里有填充字节，先清零再逐字段赋值，镜像内容才是确定的
+  CheckpointEntry entry;
+  std::memset(static_cast<void*>(&entry), 0, sizeof(entry));
+  entry.secid = secid;
+  entry.ordersApplied = ordersApplied;
+  entry.tradesApplied = tradesApplied;
+  entry.first = first;
+  entry.state.grid.base = state.grid.base;
+  entry.state.grid.tick = state.grid.tick;
+  entry.state.grid.levels = state.grid.levels;
+  entry.state.lastPrice = state.lastPrice;
+  entry.state.resting = state.resting;
+  entry.state.parked = state.parked;
+  entry.state.phase = state.phase;
+  entries_.push_back(entry);
+
+  for (size_t i = first; i < orders_.size(); ++i) {
+    BookOrder order = orders_[i];
+    std::memset(&orders_[i], 0, sizeof(BookOrder));
+    orders_[i].id = order.id;
+    orders_[i].price = order.price;
+    orders_[i].quantity = order.quantity;
+    orders_[i].side = order.side;
+  }
+}
+
+bool CheckpointWriter::write(const std::string& path, uint64_t timestamp,
+                             MarketType type, bool matching,
+                             uint64_t orderRecords,
+                             uint64_t tradeRecords) const {
+  CheckpointHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.version = kCheckpointVersion;
+  header.marketType = static_cast<uint8_t>(type);
+  header.matching = matching ? 1 : 0;
+  header.timestamp = timestamp;
+  header.orderRecords = orderRecords;
+  header.tradeRecords = tradeRecords;
+  header.securityCount = entries_.size();
+  header.orderCount = orders_.size();
+
+  std::string temporary = path + ".tmp";
+  std::FILE* out = std::fopen(temporary.c_str(), "wb");
+  if (out == nullptr) {
+    return false;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+            std::fwrite(entries_.data(), sizeof(CheckpointEntry),
+                        entries_.size(), out) == entries_.size() &&
+            std::fwrite(orders_.data(), sizeof(BookOrder), orders_.size(),
+                        out) == orders_.size();
+  // 先把内容落盘再改名，崩溃后 path 要么是旧镜像，要么是完整的新镜像
+  ok = ok && std::fflush(out) == 0 && ::fsync(::fileno(out)) == 0;
+  ok = std::fclose(out) == 0 && ok;
+  return ok && std::rename(temporary.c_str(), path.c_str()) == 0 &&
+         syncDirectoryOf(path);
+}
+
+CheckpointImage::CheckpointImage(const std::string& path) : file_(path) {
+  if (file_.size() < sizeof(CheckpointHeader)) {
+    throw std::runtime_error(path + ": truncated header");
+  }
+  header_ = reinterpret_cast<const CheckpointHeader*>(file_.data());
+  if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header_->version != kCheckpointVersion) {
+    throw std::runtime_error(path + ": not an OBRCHKPT file");
+  }
+  // 先按剩余字节数约束两个计数，下面的乘法和加法才不会溢出
+  uint64_t payload = file_.size() - sizeof(CheckpointHeader);
+  if (header_->securityCount > payload / sizeof(CheckpointEntry) ||
+      header_->orderCount > payload / sizeof(BookOrder)) {
+    throw std::runtime_error(path + ": size does not match header");
+  }
+  uint64_t entryBytes = header_->securityCount * sizeof(CheckpointEntry);
+  uint64_t orderBytes = header_->orderCount * sizeof(BookOrder);
+  if (payload != entryBytes + orderBytes) {
+    throw std::runtime_error(path + ": size does not match header");
+  }
+  entries_ = reinterpret_cast<const CheckpointEntry*>(
+      file_.data() + sizeof(CheckpointHeader));
+  orders_ = reinterpret_cast<const BookOrder*>(
+      file_.data() + sizeof(CheckpointHeader) + entryBytes);
+  // 逐项相减比较，损坏的计数不会因回绕而通过检查
+  uint64_t orderCount = header_->orderCount;
+  for (const CheckpointEntry& entry : securities()) {
+    if (entry.first > orderCount ||
+        entry.state.resting > orderCount - entry.first ||
+        entry.state.parked > orderCount - entry.first - entry.state.resting) {
+      throw std::runtime_error(path + ": order range out of bounds");
+    }
+  }
+  file_.willNeed(0, file_.size());
+}
+
+}  // namespace orderbook
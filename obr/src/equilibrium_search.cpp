@@ -0,0 +1,177 @@
+#include "equilibrium_search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OBR_HAVE_AVX2_KERNEL 1
+#endif
+
+#include <cstdlib>
+
+namespace orderbook {
+
+namespace {
+
+// 候选价位的排序键，(volume, -imbalance, rank) 字典序越大越优
+struct Candidate {
+  int64_t volume = -1;  // 无效价位为 -1
+  int64_t imbalance = 0;
+  int64_t rank = -1;
+  size_t index = 0;
+
+  bool better(const Candidate& other) const {
+    if (volume != other.volume) return volume > other.volume;
+    if (imbalance != other.imbalance) return imbalance < other.imbalance;
+    return rank > other.rank;
+  }
+};
+
+// 有买单的价位按价格从高到低排在所有只有卖单的价位之前，后者从低到高
+inline int64_t rankOf(size_t index, uint64_t bidQty, size_t size) {
+  return bidQty > 0 ? static_cast<int64_t>(size + index)
+                    : static_cast<int64_t>(size - 1 - index);
+}
+
+inline Candidate evaluate(const AuctionLevels& levels, size_t i) {
+  Candidate candidate;
+  candidate.index = i;
+  int64_t b = static_cast<int64_t>(levels.bidQty[i]);
+  int64_t s = static_cast<int64_t>(levels.askQty[i]);
+  int64_t cumBuy = static_cast<int64_t>(levels.cumBid[i]);
+  int64_t cumSell = static_cast<int64_t>(levels.cumAsk[i]);
+  if ((b == 0 && s == 0) || (cumBuy > cumSell && cumBuy - b > cumSell) ||
+      (cumBuy < cumSell && cumSell - s > cumBuy)) {
+    return candidate;
+  }
+  candidate.volume = cumBuy < cumSell ? cumBuy : cumSell;
+  candidate.imbalance = std::abs((cumBuy - b) - (cumSell - s));
+  candidate.rank = rankOf(i, levels.bidQty[i], levels.size);
+  return candidate;
+}
+
+}  // namespace
+
+size_t searchEquilibriumScalar(const AuctionLevels& levels) {
+  Candidate best;
+  for (size_t i = 0; i < levels.size; ++i) {
+    Candidate candidate = evaluate(levels, i);
+    if (candidate.better(best)) {
+      best = candidate;
+    }
+  }
+  return best.volume < 0 ? levels.size : best.index;
+}
+
+#if defined(OBR_HAVE_AVX2_KERNEL)
+
+__attribute__((target("avx2"))) size_t searchEquilibriumAvx2(
+    const AuctionLevels& levels) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i none = _mm256_set1_epi64x(-1);
+  const __m256i four = _mm256_set1_epi64x(4);
+  const __m256i size = _mm256_set1_epi64x(static_cast<int64_t>(levels.size));
+  const __m256i sizeLess1 =
+      _mm256_set1_epi64x(static_cast<int64_t>(levels.size) - 1);
+
+  __m256i bestVolume = none;
+  __m256i bestImbalance = zero;
+  __m256i bestRank = none;
+  __m256i bestIndex = zero;
+  __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+
+  // 只用于非对齐加载
+  auto* bids = reinterpret_cast<const __m256i*>(levels.bidQty);
+  auto* asks = reinterpret_cast<const __m256i*>(levels.askQty);
+  auto* cumBids = reinterpret_cast<const __m256i*>(levels.cumBid);
+  auto* cumAsks = reinterpret_cast<const __m256i*>(levels.cumAsk);
+
+  size_t i = 0;
+  for (; i + 4 <= levels.size; i += 4, index = _mm256_add_epi64(index, four)) {
+    __m256i b = _mm256_loadu_si256(bids + i / 4);
+    __m256i s = _mm256_loadu_si256(asks + i / 4);
+    __m256i cumBuy = _mm256_loadu_si256(cumBids + i / 4);
+    __m256i cumSell = _mm256_loadu_si256(cumAsks + i / 4);
+    __m256i buyAbove = _mm256_sub_epi64(cumBuy, b);
+    __m256i askBelow = _mm256_sub_epi64(cumSell, s);
+
+    // 与标量 evaluate 相同的有效性判断
+    __m256i buyMore = _mm256_cmpgt_epi64(cumBuy, cumSell);
+    __m256i sellMore = _mm256_cmpgt_epi64(cumSell, cumBuy);
+    __m256i invalid = _mm256_or_si256(
+        _mm256_and_si256(buyMore, _mm256_cmpgt_epi64(buyAbove, cumSell)),
+        _mm256_and_si256(sellMore, _mm256_cmpgt_epi64(askBelow, cumBuy)));
+    __m256i noBid = _mm256_cmpeq_epi64(b, zero);
+    invalid = _mm256_or_si256(
+        invalid, _mm256_and_si256(noBid, _mm256_cmpeq_epi64(s, zero)));
+
+    __m256i volume = _mm256_blendv_epi8(cumBuy, cumSell, buyMore);
+    volume = _mm256_blendv_epi8(volume, none, invalid);
+    __m256i diff = _mm256_sub_epi64(buyAbove, askBelow);
+    __m256i imbalance = _mm256_blendv_epi8(
+        diff, _mm256_sub_epi64(zero, diff), _mm256_cmpgt_epi64(zero, diff));
+    __m256i rank = _mm256_blendv_epi8(_mm256_add_epi64(size, index),
+                                      _mm256_sub_epi64(sizeLess1, index),
+                                      noBid);
+
+    __m256i sameVolume = _mm256_cmpeq_epi64(volume, bestVolume);
+    __m256i sameImbalance = _mm256_cmpeq_epi64(imbalance, bestImbalance);
+    __m256i better = _mm256_or_si256(
+        _mm256_cmpgt_epi64(volume, bestVolume),
+        _mm256_and_si256(
+            sameVolume,
+            _mm256_or_si256(
+                _mm256_cmpgt_epi64(bestImbalance, imbalance),
+                _mm256_and_si256(sameImbalance,
+                                 _mm256_cmpgt_epi64(rank, bestRank)))));
+    bestVolume = _mm256_blendv_epi8(bestVolume, volume, better);
+    bestImbalance = _mm256_blendv_epi8(bestImbalance, imbalance, better);
+    bestRank = _mm256_blendv_epi8(bestRank, rank, better);
+    bestIndex = _mm256_blendv_epi8(bestIndex, index, better);
+  }
+
+  // 四个通道各自的最优者再加上尾部元素做一次标量归约
+  alignas(32) int64_t volumes[4];
+  alignas(32) int64_t imbalances[4];
+  alignas(32) int64_t ranks[4];
+  alignas(32) int64_t indexes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(volumes), bestVolume);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(imbalances), bestImbalance);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(ranks), bestRank);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(indexes), bestIndex);
+  Candidate best;
+  for (int lane = 0; lane < 4; ++lane) {
+    Candidate candidate{volumes[lane], imbalances[lane], ranks[lane],
+                        static_cast<size_t>(indexes[lane])};
+    if (candidate.better(best)) {
+      best = candidate;
+    }
+  }
+  for (; i < levels.size; ++i) {
+    Candidate candidate = evaluate(levels, i);
+    if (candidate.better(best)) {
+      best = candidate;
+    }
+  }
+  return best.volume < 0 ? levels.size : best.index;
+}
+
+bool hasAvx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#else
+
+size_t searchEquilibriumAvx2(const AuctionLevels& levels) {
+  return searchEquilibriumScalar(levels);
+}
+
+bool hasAvx2() { return false; }
+
+#endif
+
+size_t searchEquilibrium(const AuctionLevels& levels) {
+  return hasAvx2() ? searchEquilibriumAvx2(levels)
+                   : searchEquilibriumScalar(levels);
+}
+
+}  // namespace orderbook
@@ -1,517 +1,535 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <queue>
-#include <deque>
-#include <stack>
-#include <thread>
-#include <list>
-#include <unordered_set>
-#include <fstream>
-#include <algorithm>
-#include <map>
-#include <set>
-#include <functional>
-#include <memory>
-#include <cassert>
-
-
-using namespace std;
-using namespace std::placeholders;
-
-
-struct Order {
-    uint64_t id;
-    int64_t price;
-    uint64_t quantity;
-    int8_t side; // 1 for buy, 2 for sell
-};
+#include "full_order.h"
 
+#include <algorithm>
+#include <iostream>
 
-struct OptimPriceInfo {
-    int64_t dealPrice;
-    int64_t expectedDealQuantity;
-    int64_t buyAboveQuantity;
-    int64_t askBelowQuantity;
-    int64_t buyDealPriceLeftQuantity;
-    int64_t askDealPriceRightQuantity;
-
-    bool operator>(const OptimPriceInfo& other) const {
-        uint64_t quantityDiff = std::abs(buyAboveQuantity - askBelowQuantity);
-        uint64_t otherQuantityDiff = std::abs(other.buyAboveQuantity - other.askBelowQuantity);
-        return expectedDealQuantity > other.expectedDealQuantity ||
-               (expectedDealQuantity == other.expectedDealQuantity && quantityDiff < otherQuantityDiff);
+namespace orderbook {
+
+namespace {
+
+// countAuctionTrades 中一侧的配对游标操作
+struct AuctionSide {
+  const PriceLadder& ladder;
+  const OrderPool& pool;
+  std::vector<std::vector<uint64_t>>& cache;
+  bool isBuy;
+
+  // 本档各委托的累计数量，失效时沿队列重建
+  const std::vector<uint64_t>& cuts(int64_t level) const {
+    std::vector<uint64_t>& levelCuts = cache[level];
+    if (levelCuts.empty()) {
+      uint64_t sum = 0;
+      for (uint32_t node = ladder.level(static_cast<uint32_t>(level)).head;
+           node != OrderPool::kNull; node = pool[node].next) {
+        sum += pool[node].order.quantity;
+        levelCuts.push_back(sum);
+      }
     }
-};
-
-struct OrderBookStatus {
-    uint64_t nts;
-    int64_t cvl;
-    int64_t cto;
-    int64_t lpr;
-
-    int bp[5];
-    int ap[5];
-    int bs[5];
-    int as[5];
-
-    void printInfo() const {
-        cout << "NTS: " << nts << ", CVL: " << cvl << ", CTO: " << cto << ", LPR: " << lpr << "\n";
-        cout << "Bid Prices: ";
-        for (int i = 0; i < 5; ++i) {
-            cout << bp[i] << " ";
-        }
-        cout << "\nAsk Prices: ";
-        for (int i = 0; i < 5; ++i) {
-            cout << ap[i] << " ";
-        }
-
-        cout << "\nBid Sizes: ";
-        for (int i = 0; i < 5; ++i) {
-            cout << bs[i] << " ";
-        }
-        cout << "\nAsk Sizes: ";
-        for (int i = 0; i < 5; ++i) {
-            cout << as[i] << " ";
-        }
-        cout << "\n";
-        cout << "----------------------------\n\n";
+    return levelCuts;
+  }
+
+  // 返回 false 表示该侧已无委托
+  bool nextLevel(AuctionCursor& cursor) const {
+    cursor.level = isBuy ? ladder.atOrBelow(cursor.level - 1)
+                         : ladder.atOrAbove(cursor.level + 1);
+    cursor.order = 0;
+    cursor.filled = 0;
+    return cursor.level != PriceLadder::kNone;
+  }
+
+  bool nextOrder(AuctionCursor& cursor) const {
+    const std::vector<uint64_t>& levelCuts = cuts(cursor.level);
+    cursor.filled = levelCuts[cursor.order];
+    if (++cursor.order == levelCuts.size()) {
+      return nextLevel(cursor);
+    }
+    return true;
+  }
+
+  // 当前委托先配完，本档其后累计到 end 为止的委托都与对侧同一笔委托成交，
+  // end 落在本档内。返回成交笔数，对侧委托在 end 处结束
+  uint64_t pairRun(AuctionCursor& cursor, uint64_t end) const {
+    const std::vector<uint64_t>& levelCuts = cuts(cursor.level);
+    // 多数情况只跨一两笔，先倍增步长再二分
+    size_t lo = cursor.order + 1;
+    size_t step = 1;
+    while (lo + step < levelCuts.size() && levelCuts[lo + step] <= end) {
+      lo += step;
+      step *= 2;
+    }
+    size_t hi = std::min(lo + step, levelCuts.size());
+    size_t next = std::upper_bound(levelCuts.begin() + lo,
+                                   levelCuts.begin() + hi, end) -
+                  levelCuts.begin();
+    uint64_t trades = next - cursor.order;
+    if (levelCuts[next - 1] != end) {
+      ++trades;
     }
+    cursor.order = static_cast<uint32_t>(next);
+    cursor.filled = end;
+    return trades;
+  }
 };
 
-struct ConfigurableComparator {
-    bool is_ascending;
-    explicit ConfigurableComparator(bool asc) : is_ascending(asc) {}
+}  // namespace
+
+void OrderBookStatus::printInfo() const {
+  std::cout << "NTS: " << nts << ", CVL: " << cvl << ", CTO: " << cto
+            << ", LPR: " << lpr << "\n";
+  std::cout << "Bid Prices: ";
+  for (int i = 0; i < 5; ++i) {
+    std::cout << bp[i] << " ";
+  }
+  std::cout << "\nAsk Prices: ";
+  for (int i = 0; i < 5; ++i) {
+    std::cout << ap[i] << " ";
+  }
+
+  std::cout << "\nBid Sizes: ";
+  for (int i = 0; i < 5; ++i) {
+    std::cout << bs[i] << " ";
+  }
+  std::cout << "\nAsk Sizes: ";
+  for (int i = 0; i < 5; ++i) {
+    std::cout << as[i] << " ";
+  }
+  std::cout << "\n";
+  std::cout << "----------------------------\n\n";
+}
 
-    bool operator()(uint64_t a, uint64_t b) const {
-        return is_ascending ? (a < b) : (a > b);
-    }
-};
+OrderBook::OrderBook(PriceGrid grid, size_t expectedOrders)
+    : index_(expectedOrders) {
+  pool_.reserve(expectedOrders);
+  bids_.reset(grid);
+  asks_.reset(grid);
+  auction_.reset(grid);
+}
 
-struct PriceLevel {
-    uint64_t quantity;
-    list<Order> orders;
-};
+void OrderBook::reset() {
+  PriceGrid grid = auction_.grid();
+  pool_.reset();
+  index_.clear();
+  bids_.reset(grid);
+  asks_.reset(grid);
+  auction_.reset(grid);
+  touchAll();
+  status_ = OrderBookStatus{};
+  phase_ = TradingPhase::CLOSED;
+}
 
-using OrderBookMap = std::map<uint64_t, PriceLevel, ConfigurableComparator>;
+void OrderBook::exportOrders(std::vector<BookOrder>& orders) const {
+  for (const PriceLadder* side : {&bids_, &asks_}) {
+    for (int64_t i = side->lowest(); i != PriceLadder::kNone;
+         i = side->atOrAbove(i + 1)) {
+      for (uint32_t node = side->level(i).head; node != OrderPool::kNull;
+           node = pool_[node].next) {
+        orders.push_back(pool_[node].order);
+      }
+    }
+  }
+}
 
+void OrderBook::restore(PriceGrid grid, TradingPhase phase,
+                        const BookOrder* orders, size_t count) {
+  auction_.reset(grid);
+  reset();
+  pool_.reserve(count);
+  index_.reserve(count);
+  // 按队列顺序逐笔追加即可恢复时间优先
+  for (size_t i = 0; i < count; ++i) {
+    addOrder(orders[i]);
+  }
+  phase_ = phase;
+}
 
+uint32_t OrderBook::addOrder(const BookOrder& order) {
+  if (order.quantity == 0 || (order.side != 1 && order.side != 2) ||
+      index_.find(order.id) != nullptr) {
+    return OrderPool::kNull;
+  }
+  if (!auction_.grid().contains(order.price)) {
+    extendGrid(order.price);
+  }
+  uint32_t node = pool_.allocate(order);
+  if (order.side == 1) {
+    bids_.append(pool_, node);
+  } else {
+    asks_.append(pool_, node);
+  }
+  auction_.add(order.side == 1, order.price, order.quantity);
+  touchLevel(order.side == 1, order.price, order.quantity);
+  index_.insert(order.id, node);
+  return node;
+}
 
+void OrderBook::removeNode(uint32_t node) {
+  const BookOrder& order = pool_[node].order;
+  bool isBuy = order.side == 1;
+  auction_.add(isBuy, order.price, -static_cast<int64_t>(order.quantity));
+  touchLevel(isBuy, order.price);
+  (isBuy ? bids_ : asks_).unlink(pool_, node);
+  pool_.release(node);
+}
 
-class OrderIterator {
-public:
-    using iterator_category = std::forward_iterator_tag;
-    using value_type = Order;
-    using difference_type = std::ptrdiff_t;
-    using pointer = Order*;
-    using reference = Order&;
+bool OrderBook::cancelOrder(uint64_t id) {
+  const uint32_t* node = index_.find(id);
+  if (node == nullptr) {
+    return false;
+  }
+  removeNode(*node);
+  index_.erase(id);
+  return true;
+}
 
-    OrderIterator() = default;
-    
-    explicit OrderIterator(OrderBookMap& price_map, bool is_end = false)
-        : map_iter(is_end ? price_map.end() : price_map.begin()),
-          map_end(price_map.end()) {
-        if (map_iter != map_end) {
-            list_iter = map_iter->second.orders.begin();
-            advance_to_valid();
-        }
-    }
+bool OrderBook::fillNode(uint32_t node, uint64_t quantity) {
+  const BookOrder& order = pool_[node].order;
+  if (quantity >= order.quantity) {
+    index_.erase(order.id);
+    removeNode(node);
+    return true;
+  }
+  bool isBuy = order.side == 1;
+  auction_.add(isBuy, order.price, -static_cast<int64_t>(quantity));
+  touchLevel(isBuy, order.price);
+  (isBuy ? bids_ : asks_).reduce(pool_, node, quantity);
+  return false;
+}
 
-    reference operator*() {
-        return *list_iter;
-    }
-    
-    pointer operator->() {
-        return &(*list_iter);
-    }
+bool OrderBook::fillOrder(uint64_t id, uint64_t quantity) {
+  const uint32_t* node = index_.find(id);
+  if (node == nullptr) {
+    return false;
+  }
+  fillNode(*node, quantity);
+  return true;
+}
 
-    OrderIterator& operator++() {
-        if (map_iter == map_end) return *this;
-        
-        ++list_iter;
-        advance_to_valid();
-        return *this;
-    }
+void OrderBook::advance(uint64_t timestamp,
+                        std::vector<Execution>& executions) {
+  TradingPhase phase = phaseAt(timestamp);
+  if (phase != phase_ && isAuction(phase_)) {
+    uncross(executions);
+  }
+  phase_ = phase;
+}
 
-    OrderIterator operator++(int) {
-        OrderIterator tmp = *this;
-        ++(*this);
-        return tmp;
-    }
+void OrderBook::uncross(std::vector<Execution>& executions) {
+  if (!auction_.crossed()) {
+    return;
+  }
+  int64_t price = auction_.equilibrium().dealPrice;
+  uint64_t volume = auction_.matchedVolume();
+  while (volume > 0) {
+    uint32_t buy = bids_.level(bids_.highest()).head;
+    uint32_t sell = asks_.level(asks_.lowest()).head;
+    uint64_t quantity = std::min({volume, pool_[buy].order.quantity,
+                                  pool_[sell].order.quantity});
+    executions.push_back(
+        Execution{pool_[buy].order.id, pool_[sell].order.id, price, quantity});
+    fillNode(buy, quantity);
+    fillNode(sell, quantity);
+    volume -= quantity;
+  }
+}
 
-    OrderBookMap::iterator getMapIter() const {
-        return map_iter;
+uint64_t OrderBook::available(bool isBuy, int64_t limit,
+                              uint64_t need) const {
+  const PriceLadder& ladder = isBuy ? bids_ : asks_;
+  const PriceGrid& grid = ladder.grid();
+  uint64_t total = 0;
+  for (int64_t i = isBuy ? ladder.highest() : ladder.lowest();
+       i != PriceLadder::kNone && total < need;
+       i = isBuy ? ladder.atOrBelow(i - 1) : ladder.atOrAbove(i + 1)) {
+    int64_t price = grid.price(i);
+    if (isBuy ? price < limit : price > limit) {
+      break;
     }
+    total += ladder.level(i).quantity;
+  }
+  return total;
+}
 
-    bool operator==(const OrderIterator& other) const {
-        if (map_iter != other.map_iter) return false;
-        if (map_iter == map_end) return true;
-        return list_iter == other.list_iter;
+uint64_t OrderBook::match(BookOrder& taker, int64_t limit,
+                          std::vector<Execution>& executions) {
+  bool isBuy = taker.side == 1;
+  const PriceLadder& resting = isBuy ? asks_ : bids_;
+  uint64_t executed = 0;
+  while (taker.quantity > 0) {
+    int64_t index = isBuy ? resting.lowest() : resting.highest();
+    if (index == PriceLadder::kNone) {
+      break;
     }
-    
-    bool operator!=(const OrderIterator& other) const {
-        return !(*this == other);
+    int64_t price = resting.grid().price(index);
+    if (isBuy ? price > limit : price < limit) {
+      break;
     }
+    // 价格优先、时间优先：吃掉该价位队首的委托
+    uint32_t maker = resting.level(index).head;
+    const BookOrder& order = pool_[maker].order;
+    uint64_t quantity = std::min(taker.quantity, order.quantity);
+    executions.push_back(isBuy ? Execution{taker.id, order.id, price, quantity}
+                               : Execution{order.id, taker.id, price, quantity});
+    fillNode(maker, quantity);
+    taker.quantity -= quantity;
+    executed += quantity;
+  }
+  return executed;
+}
 
+uint64_t OrderBook::submitOrder(const BookOrder& order, OrderType type,
+                                uint64_t timestamp,
+                                std::vector<Execution>& executions) {
+  advance(timestamp, executions);
+  if (phase_ == TradingPhase::CLOSED ||
+      (isAuction(phase_) && type != OrderType::LIMIT)) {
+    return 0;
+  }
+  if (isAuction(phase_)) {
+    addOrder(order);
+    return 0;
+  }
+
+  bool isBuy = order.side == 1;
+  int64_t limit = order.price;
+  switch (type) {
+    case OrderType::LIMIT:
+      break;
+    case OrderType::MARKET:
+      limit = isBuy ? bestAsk() : bestBid();
+      if (limit == 0) {
+        return 0;
+      }
+      break;
+    case OrderType::OWN_BEST:
+      limit = isBuy ? bestBid() : bestAsk();
+      if (limit == 0) {
+        return 0;
+      }
+      break;
+    case OrderType::IOC:
+    case OrderType::FOK:
+      if (limit == 0) {
+        limit = isBuy ? INT64_MAX : INT64_MIN;
+      }
+      if (type == OrderType::FOK &&
+          available(!isBuy, limit, order.quantity) < order.quantity) {
+        return 0;
+      }
+      break;
+  }
+
+  BookOrder taker = order;
+  uint64_t executed = match(taker, limit, executions);
+  if (taker.quantity > 0 &&
+      (type == OrderType::LIMIT || type == OrderType::MARKET ||
+       type == OrderType::OWN_BEST)) {
+    taker.price = limit;
+    addOrder(taker);
+  }
+  return executed;
+}
 
+int64_t OrderBook::bestBid() const {
+  int64_t index = bids_.highest();
+  return index == PriceLadder::kNone ? 0 : bids_.grid().price(index);
+}
 
-private:
-    // 辅助函数：前进到有效位置
-    void advance_to_valid() {
-        // 跳过空列表或已到列表末尾的情况
-        while (map_iter != map_end) {
-            if (list_iter != map_iter->second.orders.end()) {
-                return;
-            }
-            
-            ++map_iter;
-            if (map_iter != map_end) {
-                list_iter = map_iter->second.orders.begin();
-            }
-        }
-    }
+int64_t OrderBook::bestAsk() const {
+  int64_t index = asks_.lowest();
+  return index == PriceLadder::kNone ? 0 : asks_.grid().price(index);
+}
 
-    OrderBookMap::iterator map_iter;
-    OrderBookMap::iterator map_end;
-    std::list<Order>::iterator list_iter;
-};
+size_t OrderBook::depth(bool isBuy, DepthLevel* levels, size_t count) const {
+  const PriceLadder& ladder = isBuy ? bids_ : asks_;
+  const PriceGrid& grid = ladder.grid();
+  size_t written = 0;
+  for (int64_t i = isBuy ? ladder.highest() : ladder.lowest();
+       i != PriceLadder::kNone && written < count;
+       i = isBuy ? ladder.atOrBelow(i - 1) : ladder.atOrAbove(i + 1)) {
+    levels[written++] = DepthLevel{grid.price(i), ladder.level(i).quantity};
+  }
+  return written;
+}
 
-OrderIterator begin(OrderBookMap& price_map) {
-    return OrderIterator(price_map);
+void OrderBook::insertOrder(const BookOrder& order) {
+  addOrder(order);
+  refreshStatus().printInfo();
 }
 
-OrderIterator end(OrderBookMap& price_map) {
-    return OrderIterator(price_map, true);
+void OrderBook::extendGrid(int64_t price) {
+  PriceGrid grid = auction_.grid().extendTo(price);
+  bids_.rebase(grid);
+  asks_.rebase(grid);
+  auction_.reset(grid);
+  touchAll();
+  for (int64_t i = bids_.lowest(); i != PriceLadder::kNone;
+       i = bids_.atOrAbove(i + 1)) {
+    auction_.add(true, grid.price(i), bids_.level(i).quantity);
+  }
+  for (int64_t i = asks_.lowest(); i != PriceLadder::kNone;
+       i = asks_.atOrAbove(i + 1)) {
+    auction_.add(false, grid.price(i), asks_.level(i).quantity);
+  }
 }
 
+OrderBookStatus OrderBook::auctionStatus() const {
+  OrderBookStatus status{};
+  if (!auction_.crossed()) {
+    return status;
+  }
+  OptimPriceInfo optimPriceInfo = auction_.equilibrium();
+  status.lpr = optimPriceInfo.dealPrice;
+  status.cvl = optimPriceInfo.expectedDealQuantity;
+  status.cto = status.cvl * optimPriceInfo.dealPrice / 10000;
+  status.nts = countAuctionTrades();
+
+  uint64_t matched = auction_.matchedVolume();
+  DepthLevel levels[5];
+  size_t bids = residualLevels(true, optimPriceInfo, matched, levels, 5);
+  for (size_t i = 0; i < bids; ++i) {
+    status.bp[4 - i] = static_cast<int>(levels[i].price);
+    status.bs[4 - i] = static_cast<int>(levels[i].quantity);
+  }
+  size_t asks = residualLevels(false, optimPriceInfo, matched, levels, 5);
+  for (size_t i = 0; i < asks; ++i) {
+    status.ap[i] = static_cast<int>(levels[i].price);
+    status.as[i] = static_cast<int>(levels[i].quantity);
+  }
+  return status;
+}
 
+size_t OrderBook::residualDepth(bool isBuy, DepthLevel* levels,
+                                size_t count) const {
+  if (!auction_.crossed()) {
+    return depth(isBuy, levels, count);
+  }
+  return residualLevels(isBuy, auction_.equilibrium(),
+                        auction_.matchedVolume(), levels, count);
+}
 
+size_t OrderBook::residualLevels(bool isBuy,
+                                 const OptimPriceInfo& optimPriceInfo,
+                                 uint64_t matched, DepthLevel* levels,
+                                 size_t count) const {
+  const PriceLadder& ladder = isBuy ? bids_ : asks_;
+  const PriceGrid& grid = ladder.grid();
+  // 撮合后剩余的第一个价位：累计量首次超过可成交量的价位，
+  // 成交价所在价位只剩未成交的部分
+  uint64_t left = static_cast<uint64_t>(
+      isBuy ? optimPriceInfo.buyDealPriceLeftQuantity
+            : optimPriceInfo.askDealPriceRightQuantity);
+  size_t written = 0;
+  for (int64_t i = isBuy ? auction_.bidLevelAfter(matched)
+                         : auction_.askLevelAfter(matched);
+       i != PriceLadder::kNone && written < count;
+       i = isBuy ? ladder.atOrBelow(i - 1) : ladder.atOrAbove(i + 1)) {
+    int64_t price = grid.price(i);
+    levels[written++] = DepthLevel{
+        price, price == optimPriceInfo.dealPrice ? left
+                                                 : ladder.level(i).quantity};
+  }
+  return written;
+}
 
-class OrderBook {
-public:
-
-    OrderBookStatus flushStatus() {
-        if (bidPriceMaps.empty() || askPriceMaps.empty()) {
-            return OrderBookStatus{};
-        } else if (bidPriceMaps.begin()->first < askPriceMaps.begin()->first) {
-            return OrderBookStatus{};
-        }
-
-        OrderBookStatus status{};
-        map<uint64_t, uint64_t, std::greater<>> bidPrefixSum;
-        map<uint64_t, uint64_t, std::less<>> askPrefixSum;
-        uint64_t totalBidQuantity = 0;
-        uint64_t totalAskQuantity = 0;
-        for (const auto& [price, level] : bidPriceMaps) {
-            bidPrefixSum[price] = totalBidQuantity;
-            totalBidQuantity += level.quantity;
-        }
-        bidPrefixSum[0] = totalBidQuantity; // Add a zero price level for easier calculations
-
-        for (const auto& [price, level] : askPriceMaps) {
-            askPrefixSum[price] = totalAskQuantity;
-            totalAskQuantity += level.quantity;
-        }
-        askPrefixSum[INT64_MAX] = totalAskQuantity; // Add a max price level for easier calculations
-
-        OptimPriceInfo optimPriceInfo;
-        optimPriceInfo.expectedDealQuantity = -1;
-
-        auto bidIt = bidPrefixSum.begin();
-        int64_t minBidPrice = askPrefixSum.begin()->first;
-        while (bidIt != bidPrefixSum.end()) {
-            if (bidIt->first < minBidPrice) {
-                break;
-            }
-            int64_t curPrice = bidIt->first;
-            int64_t currBuy = bidPriceMaps[curPrice].quantity;
-            int64_t buyAboveQuantity = bidIt->second;
-
-
-            auto askIt = askPrefixSum.lower_bound(curPrice);
-            assert(askIt != askPrefixSum.end());
-            int64_t currSell = askIt->first == curPrice ? askPriceMaps[curPrice].quantity : 0;
-            int64_t askBelowQuantity = askIt->second;
-            bool ok = true;
-            if (buyAboveQuantity + currBuy > askBelowQuantity + currSell) {
-                if (buyAboveQuantity > askBelowQuantity + currSell) {
-                    // std::cout << "can't make deal at price " << curPrice << " buyAboveQuantity: " << buyAboveQuantity << " askBelowQuantity: " << askBelowQuantity << " currBuy: " << currBuy << " currSell: " << currSell << "\n";
-                    ok = false;
-                }
-            } else if (buyAboveQuantity + currBuy < askBelowQuantity + currSell) {
-                if (askBelowQuantity > buyAboveQuantity + currBuy) {
-                    // std::cout << "can't make deal at price " << curPrice << " buyAboveQuantity: " << buyAboveQuantity << " askBelowQuantity: " << askBelowQuantity << " currBuy: " << currBuy << " currSell: " << currSell << "\n";
-                    ok = false;
-                }
-            }
-
-            if (!ok) {
-                ++bidIt;
-                continue;
-            }
-
-            int64_t expectedDealQuantity = std::min(buyAboveQuantity + currBuy, askBelowQuantity + currSell);
-            OptimPriceInfo current{
-                curPrice,
-                expectedDealQuantity,
-                buyAboveQuantity,
-                askBelowQuantity,
-                currBuy + buyAboveQuantity - expectedDealQuantity,
-                currSell + askBelowQuantity - expectedDealQuantity
-            };
-            if (current > optimPriceInfo) {
-                optimPriceInfo = current;
-            }
-            ++bidIt;
-        }
-
-        auto askIt = askPrefixSum.begin();
-        int64_t maxAskPrice = bidPrefixSum.begin()->first;
-        while (askIt != askPrefixSum.end()) {
-            if (askIt->first > maxAskPrice) {
-                break;
-            }
-            int64_t curPrice = askIt->first;
-            int64_t currSell = askPriceMaps[curPrice].quantity;
-            int64_t askBelowQuantity = askIt->second;
-
-            auto bidIt = bidPrefixSum.lower_bound(curPrice);
-            assert(bidIt != bidPrefixSum.end());
-            int64_t currBuy = bidIt->first == curPrice ? bidPriceMaps[curPrice].quantity : 0;
-            int64_t buyAboveQuantity = bidIt->second;
-            bool ok = true;
-            if (buyAboveQuantity + currBuy > askBelowQuantity + currSell) {
-                if (buyAboveQuantity > askBelowQuantity + currSell) {
-                    // std::cout << "can't make deal at price " << curPrice << " buyAboveQuantity: " << buyAboveQuantity << " askBelowQuantity: " << askBelowQuantity << " currBuy: " << currBuy << " currSell: " << currSell << "\n";
-                    ok = false;
-                }
-            } else if (buyAboveQuantity + currBuy < askBelowQuantity + currSell) {
-                if (askBelowQuantity > buyAboveQuantity + currBuy) {
-                    // std::cout << "can't make deal at price " << curPrice << " buyAboveQuantity: " << buyAboveQuantity << " askBelowQuantity: " << askBelowQuantity << " currBuy: " << currBuy << " currSell: " << currSell << "\n";
-                    ok = false;
-                }
-            }
-            if (!ok) {
-                ++askIt;
-                continue;
-            }
-            int64_t expectedDealQuantity = std::min(buyAboveQuantity + currBuy, askBelowQuantity + currSell);
-            OptimPriceInfo current{
-                curPrice,
-                expectedDealQuantity,
-                buyAboveQuantity,
-                askBelowQuantity,
-                currBuy + buyAboveQuantity - expectedDealQuantity,
-                currSell + askBelowQuantity - expectedDealQuantity
-            };
-            if (current > optimPriceInfo) {
-                optimPriceInfo = current;
-            }
-            ++askIt;
-        }
-
-        status.lpr = optimPriceInfo.dealPrice;
-        status.cvl = optimPriceInfo.expectedDealQuantity;
-
-        status.cto = status.cvl * optimPriceInfo.dealPrice / 10000;
-        
-        int64_t tradeCount = 0;
-
-        OrderIterator buyOrderIt = begin(bidPriceMaps);
-        OrderIterator sellOrderIt = begin(askPriceMaps);
-        Order buyOrder = *buyOrderIt;
-        Order sellOrder = *sellOrderIt;
-        
-
-        while (1) {
-            if (buyOrder.price < sellOrder.price) {
-                break;
-            }
-            uint64_t tradeVolume = std::min(buyOrder.quantity, sellOrder.quantity);
-            buyOrder.quantity -= tradeVolume;
-            sellOrder.quantity -= tradeVolume;
-            ++tradeCount;
-
-            bool finished = false;
-            if (buyOrder.quantity == 0) {
-                ++buyOrderIt;
-                if (buyOrderIt == end(bidPriceMaps)) {
-                    finished = true;
-                } else {
-                    buyOrder = *buyOrderIt;
-                }
-            }
-            if (sellOrder.quantity == 0) {
-                ++sellOrderIt;
-                if (sellOrderIt == end(askPriceMaps)) {    
-                    finished = true;
-                } else {
-                    sellOrder = *sellOrderIt;
-                }
-            }
-            if (finished) {
-                break;
-            }
-        }
-
-
-        status.nts = tradeCount;
-
-        auto bidIter = buyOrderIt.getMapIter();
-        auto askIter = sellOrderIt.getMapIter();
-        int count = 4;
-        while (bidIter != bidPriceMaps.end() && count >= 0) {
-            status.bp[count] = bidIter->first;
-
-            if (bidIter->first == optimPriceInfo.dealPrice) {
-                status.bs[count] = optimPriceInfo.buyDealPriceLeftQuantity;
-            } else {
-                status.bs[count] = bidIter->second.quantity;
-            }
-            --count;
-            ++bidIter;
-        }
-
-        count = 0;
-        while (askIter != askPriceMaps.end() && count < 5) {
-            status.ap[count] = askIter->first;
-            if (askIter->first == optimPriceInfo.dealPrice) {
-                status.as[count] = optimPriceInfo.askDealPriceRightQuantity;
-            } else {
-                status.as[count] = askIter->second.quantity;
-            }
-            ++count;
-            ++askIter;
-        }
-
-        /*
-        auto bidIter = bidPriceMaps.begin();
-        auto askIter = askPriceMaps.begin();
-        
-        auto buyOrderIt = bidIter->second.orders.begin();
-        auto sellOrderIt = askIter->second.orders.begin();
-        int64_t tradeCount = 0;
-
-
-        Order buyOrder = *buyOrderIt;
-        Order sellOrder = *sellOrderIt;
-        
-
-        while (1) {
-            if (buyOrder.price < sellOrder.price) {
-                break;
-            }
-            uint64_t tradeVolume = std::min(buyOrder.quantity, sellOrder.quantity);
-            buyOrder.quantity -= tradeVolume;
-            sellOrder.quantity -= tradeVolume;
-            ++tradeCount;
-
-            bool finished = false;
-            if (buyOrder.quantity == 0) {
-                ++buyOrderIt;
-                if (buyOrderIt == bidIter->second.orders.end()) {
-                    ++bidIter;
-                    if (bidIter == bidPriceMaps.end()) {
-                        finished = true;
-                    } else {
-                        buyOrderIt = bidIter->second.orders.begin();
-                        buyOrder = *buyOrderIt;
-                    }
-                } else {
-                    buyOrder = *buyOrderIt;
-                }
-            }
-            if (sellOrder.quantity == 0) {
-                ++sellOrderIt;
-                if (sellOrderIt == askIter->second.orders.end()) {
-                    ++askIter;
-                    if (askIter == askPriceMaps.end()) {    
-                        finished = true;
-                    } else {
-                        sellOrderIt = askIter->second.orders.begin();
-                        sellOrder = *sellOrderIt;
-                    }
-                } else {
-                    sellOrder = *sellOrderIt;
-                }
-            }
-            if (finished) {
-                break;
-            }
-        }
-
-
-        status.nts = tradeCount;
-
-        int count = 4;
-        while (bidIter != bidPriceMaps.end() && count >= 0) {
-            status.bp[count] = bidIter->first;
-
-            if (bidIter->first == optimPriceInfo.dealPrice) {
-                status.bs[count] = optimPriceInfo.buyDealPriceLeftQuantity;
-            } else {
-                status.bs[count] = bidIter->second.quantity;
-            }
-            --count;
-            ++bidIter;
-        }
-
-        count = 0;
-        while (askIter != askPriceMaps.end() && count < 5) {
-            status.ap[count] = askIter->first;
-            if (askIter->first == optimPriceInfo.dealPrice) {
-                status.as[count] = optimPriceInfo.askDealPriceRightQuantity;
-            } else {
-                status.as[count] = askIter->second.quantity;
-            }
-            ++count;
-            ++askIter;
-        }
-        */
-
-        return status;
+uint64_t OrderBook::countAuctionTrades() const {
+  if (touchedBid_ == PriceLadder::kNone && touchedAsk_ == INT64_MAX &&
+      !checkpoints_.empty()) {
+    return auctionTrades_;
+  }
+  // 检查点按配对进度排列，丢弃所有已经走到改动价位的
+  while (!checkpoints_.empty() &&
+         (checkpoints_.back().bid.level <= touchedBid_ ||
+          checkpoints_.back().ask.level >= touchedAsk_)) {
+    checkpoints_.pop_back();
+  }
+  touchedBid_ = PriceLadder::kNone;
+  touchedAsk_ = INT64_MAX;
+
+  const PriceGrid& grid = auction_.grid();
+  if (bidCuts_.size() != grid.levels) {
+    bidCuts_.resize(grid.levels);
+    askCuts_.resize(grid.levels);
+  }
+  AuctionSide bids{bids_, pool_, bidCuts_, true};
+  AuctionSide asks{asks_, pool_, askCuts_, false};
+  AuctionCheckpoint state{};
+  if (checkpoints_.empty()) {
+    state.bid.level = bids_.highest();
+    state.ask.level = asks_.lowest();
+    checkpoints_.push_back(state);
+  } else {
+    state = checkpoints_.back();
+  }
+  AuctionCursor& buy = state.bid;
+  AuctionCursor& sell = state.ask;
+
+  while (buy.level >= sell.level) {
+    const AuctionCheckpoint& last = checkpoints_.back();
+    if (buy.level != last.bid.level || sell.level != last.ask.level) {
+      checkpoints_.push_back(state);
     }
-
-    
-
-    void insertOrder(const Order& order) {
-        if (order.side == 1) { // Buy order
-            auto& priceLevel = bidPriceMaps[order.price];
-            priceLevel.quantity += order.quantity;
-            priceLevel.orders.push_back(order);
-        } else if (order.side == 2) { // Sell order
-            auto& priceLevel = askPriceMaps[order.price];
-            priceLevel.quantity += order.quantity;
-            priceLevel.orders.push_back(order);
-        }
-
-        auto obs = flushStatus();
-        obs.printInfo();
+    const std::vector<uint64_t>& buyCuts = bids.cuts(buy.level);
+    const std::vector<uint64_t>& sellCuts = asks.cuts(sell.level);
+    uint64_t buyQuantity = buyCuts[buy.order] - buy.filled;
+    uint64_t sellQuantity = sellCuts[sell.order] - sell.filled;
+    uint64_t buyLevelQuantity = buyCuts.back() - buy.filled;
+    uint64_t sellLevelQuantity = sellCuts.back() - sell.filled;
+    // 一侧剩余的整档装得进对侧当前委托时，该档每笔委托各成交一次
+    bool more = true;
+    if (sellLevelQuantity <= buyQuantity) {
+      state.trades += sellCuts.size() - sell.order;
+      buy.filled += sellLevelQuantity;
+      more = asks.nextLevel(sell);
+      if (buyQuantity == sellLevelQuantity) {
+        more = bids.nextOrder(buy) && more;
+      }
+    } else if (buyLevelQuantity <= sellQuantity) {
+      state.trades += buyCuts.size() - buy.order;
+      sell.filled += buyLevelQuantity;
+      more = bids.nextLevel(buy);
+      if (sellQuantity == buyLevelQuantity) {
+        more = asks.nextOrder(sell) && more;
+      }
+    } else if (buyQuantity <= sellQuantity) {
+      state.trades += bids.pairRun(buy, buy.filled + sellQuantity);
+      more = asks.nextOrder(sell);
+    } else {
+      state.trades += asks.pairRun(sell, sell.filled + buyQuantity);
+      more = bids.nextOrder(buy);
     }
-
-    void printOrderBook() const {
-        cout << "Bid Price Levels:\n";
-        for (const auto& [price, level] : bidPriceMaps) {
-            cout << "Price: " << price << ", Quantity: " << level.quantity << "\n";
-            for (const auto& order : level.orders) {
-                cout << "  Order ID: " << order.id << ", Quantity: " << order.quantity << "\n";
-            }
-        }
-        cout << "----------------------------\n";
-        cout << "\nAsk Price Levels:\n";
-        for (const auto& [price, level] : askPriceMaps) {
-            cout << "Price: " << price << ", Quantity: " << level.quantity << "\n";
-            for (const auto& order : level.orders) {
-                cout << "  Order ID: " << order.id << ", Quantity: " << order.quantity << "\n";
-            }
-        }
+    if (!more) {
+      break;
     }
-private:
-    OrderBookMap askPriceMaps{ConfigurableComparator(true)};
-    OrderBookMap bidPriceMaps{ConfigurableComparator(false)};
+  }
+  auctionTrades_ = state.trades;
+  return auctionTrades_;
+}
 
-    // map<uint64_t, PriceLevel, std::greater<>> bidPriceMaps;
-    // map<uint64_t, PriceLevel, std::less<>> askPriceMaps;
+void OrderBook::printOrderBook() const {
+  const PriceGrid& grid = auction_.grid();
+  std::cout << "Bid Price Levels:\n";
+  for (int64_t i = bids_.highest(); i != PriceLadder::kNone;
+       i = bids_.atOrBelow(i - 1)) {
+    std::cout << "Price: " << grid.price(i)
+              << ", Quantity: " << bids_.level(i).quantity << "\n";
+    for (uint32_t node = bids_.level(i).head; node != OrderPool::kNull;
+         node = pool_[node].next) {
+      std::cout << "  Order ID: " << pool_[node].order.id
+                << ", Quantity: " << pool_[node].order.quantity << "\n";
+    }
+  }
+  std::cout << "----------------------------\n";
+  std::cout << "\nAsk Price Levels:\n";
+  for (int64_t i = asks_.lowest(); i != PriceLadder::kNone;
+       i = asks_.atOrAbove(i + 1)) {
+    std::cout << "Price: " << grid.price(i)
+              << ", Quantity: " << asks_.level(i).quantity << "\n";
+    for (uint32_t node = asks_.level(i).head; node != OrderPool::kNull;
+         node = pool_[node].next) {
+      std::cout << "  Order ID: " << pool_[node].order.id
+                << ", Quantity: " << pool_[node].order.quantity << "\n";
+    }
+  }
+}
 
-};
+}  // namespace orderbook
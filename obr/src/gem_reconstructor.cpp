@@ -0,0 +1,138 @@
+#include "gem_reconstructor.h"
+
+namespace orderbook {
+
+bool GemReconstructor::withinCage(const BookOrder& order) const {
+  int64_t bestBid = book_.bestBid();
+  int64_t bestAsk = book_.bestAsk();
+  int64_t benchmark;
+  if (order.side == 1) {
+    benchmark = bestAsk ? bestAsk : (bestBid ? bestBid : lastPrice_);
+    return benchmark == 0 || order.price * 100 <= benchmark * 102 ||
+           order.price <= benchmark + 10 * kTick;
+  }
+  benchmark = bestBid ? bestBid : (bestAsk ? bestAsk : lastPrice_);
+  return benchmark == 0 || order.price * 100 >= benchmark * 98 ||
+         order.price >= benchmark - 10 * kTick;
+}
+
+void GemReconstructor::cage(const BookOrder& order) {
+  caged_.insert(order.id, order);
+  if (order.side == 1) {
+    cagedBuys_.emplace(order.price, order.id);
+  } else {
+    cagedSells_.emplace(order.price, order.id);
+  }
+}
+
+bool GemReconstructor::uncage(uint64_t id) {
+  const BookOrder* order = caged_.find(id);
+  if (order == nullptr) {
+    return false;
+  }
+  auto erase = [id](auto& queue, int64_t price) {
+    auto [first, last] = queue.equal_range(price);
+    for (auto it = first; it != last; ++it) {
+      if (it->second == id) {
+        queue.erase(it);
+        return;
+      }
+    }
+  };
+  if (order->side == 1) {
+    erase(cagedBuys_, order->price);
+  } else {
+    erase(cagedSells_, order->price);
+  }
+  caged_.erase(id);
+  return true;
+}
+
+void GemReconstructor::releaseCaged(uint64_t timestamp) {
+  if (caged_.empty()) {
+    return;
+  }
+  bool continuous = phaseAt(timestamp) == TradingPhase::CONTINUOUS;
+  // 一侧转入订单簿会改变另一侧的基准价，直到两侧都没有可转入的订单
+  for (bool released = true; released;) {
+    released = false;
+    while (!cagedBuys_.empty()) {
+      BookOrder order = *caged_.find(cagedBuys_.begin()->second);
+      if (continuous && !withinCage(order)) {
+        break;
+      }
+      cagedBuys_.erase(cagedBuys_.begin());
+      caged_.erase(order.id);
+      enter(order, OrderType::LIMIT, timestamp);
+      released = true;
+    }
+    while (!cagedSells_.empty()) {
+      BookOrder order = *caged_.find(cagedSells_.begin()->second);
+      if (continuous && !withinCage(order)) {
+        break;
+      }
+      cagedSells_.erase(cagedSells_.begin());
+      caged_.erase(order.id);
+      enter(order, OrderType::LIMIT, timestamp);
+      released = true;
+    }
+  }
+}
+
+void GemReconstructor::processOrder(const Order& order) {
+  if (order.type == OrderType::LIMIT &&
+      phaseAt(order.timestamp) == TradingPhase::CONTINUOUS) {
+    BookOrder entry{order.order_id, order.price, order.quantity,
+                    static_cast<int8_t>(order.is_buy ? 1 : 2)};
+    if (!withinCage(entry)) {
+      executions_.clear();
+      cage(entry);
+      return;
+    }
+  }
+  MainBoardReconstructor::processOrder(order);
+  releaseCaged(order.timestamp);
+}
+
+void GemReconstructor::processTrade(const Trade& trade) {
+  if (trade.type == TradeType::CANCEL) {
+    if (uncage(trade.bid_order_id != 0 ? trade.bid_order_id
+                                       : trade.ask_order_id)) {
+      executions_.clear();
+      return;
+    }
+  }
+  MainBoardReconstructor::processTrade(trade);
+  releaseCaged(trade.timestamp);
+}
+
+ReconstructorState GemReconstructor::saveState(
+    std::vector<BookOrder>& orders) const {
+  ReconstructorState state = MainBoardReconstructor::saveState(orders);
+  // 按暂存队列顺序保存，恢复时依次 cage 即可还原同价位的先后
+  for (const auto& entry : cagedBuys_) {
+    orders.push_back(*caged_.find(entry.second));
+  }
+  for (const auto& entry : cagedSells_) {
+    orders.push_back(*caged_.find(entry.second));
+  }
+  state.parked = caged_.size();
+  return state;
+}
+
+void GemReconstructor::restoreState(const ReconstructorState& state,
+                                    const BookOrder* orders) {
+  MainBoardReconstructor::restoreState(state, orders);
+  caged_.clear();
+  cagedBuys_.clear();
+  cagedSells_.clear();
+  for (uint64_t i = 0; i < state.parked; ++i) {
+    cage(orders[state.resting + i]);
+  }
+}
+
+size_t GemReconstructor::processEvents(const Event* events, size_t count) {
+  return dispatchEvents(*this, events, count);
+}
+
+}  // namespace orderbook
@@ -0,0 +1,183 @@
+#include "live_feed.h"
+
+#include <cstring>
+
+namespace orderbook {
+
+namespace {
+
+constexpr size_t kHeaderSize = 8;  // MsgType + BodyLength
+constexpr size_t kChecksumSize = 4;
+
+// 逐笔委托消息体各字段偏移
+namespace order_body {
+constexpr size_t kApplSeqNum = 2;
+constexpr size_t kSecurityID = 13;
+constexpr size_t kPrice = 25;
+constexpr size_t kOrderQty = 33;
+constexpr size_t kSide = 41;
+constexpr size_t kTransactTime = 42;
+constexpr size_t kOrdType = 50;
+constexpr size_t kSize = 51;
+}  // namespace order_body
+
+// 逐笔成交消息体各字段偏移
+namespace trade_body {
+constexpr size_t kApplSeqNum = 2;
+constexpr size_t kBidApplSeqNum = 13;
+constexpr size_t kOfferApplSeqNum = 21;
+constexpr size_t kSecurityID = 29;
+constexpr size_t kLastPx = 41;
+constexpr size_t kLastQty = 49;
+constexpr size_t kExecType = 57;
+constexpr size_t kTransactTime = 58;
+constexpr size_t kSize = 66;
+}  // namespace trade_body
+
+constexpr int64_t kQuantityScale = 100;  // N15(2)
+constexpr size_t kSecurityIDSize = 8;
+
+uint32_t loadU32(const char* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return __builtin_bswap32(value);
+}
+
+int64_t loadI64(const char* p) {
+  uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return static_cast<int64_t>(__builtin_bswap64(value));
+}
+
+// 证券代码为右补空格的数字串，如 "300750  "
+uint32_t parseSecurityID(const char* p) {
+  uint32_t secid = 0;
+  for (size_t i = 0; i < kSecurityIDSize && p[i] >= '0' && p[i] <= '9'; ++i) {
+    secid = secid * 10 + static_cast<uint32_t>(p[i] - '0');
+  }
+  return secid;
+}
+
+uint32_t quantityOf(const char* p) {
+  return static_cast<uint32_t>(loadI64(p) / kQuantityScale);
+}
+
+// '1' 市价（对手方最优），'2' 限价，'U' 本方最优：行情中的价格无意义，
+// 由重建器按入簿时的本方最优价定价
+OrderType orderTypeOf(char c) {
+  switch (c) {
+    case '1':
+      return OrderType::MARKET;
+    case 'U':
+      return OrderType::OWN_BEST;
+    default:
+      return OrderType::LIMIT;
+  }
+}
+
+Event decodeOrder(const char* body) {
+  using namespace order_body;
+  Order order{};
+  order.timestamp = static_cast<uint64_t>(loadI64(body + kTransactTime));
+  order.order_id = static_cast<uint64_t>(loadI64(body + kApplSeqNum));
+  order.price = loadI64(body + kPrice);
+  order.secid = parseSecurityID(body + kSecurityID);
+  order.quantity = quantityOf(body + kOrderQty);
+  order.is_buy = body[kSide] == '1';
+  order.type = orderTypeOf(body[kOrdType]);
+  return Event::of(order);
+}
+
+Event decodeTrade(const char* body) {
+  using namespace trade_body;
+  Trade trade{};
+  trade.timestamp = static_cast<uint64_t>(loadI64(body + kTransactTime));
+  trade.trade_id = static_cast<uint64_t>(loadI64(body + kApplSeqNum));
+  trade.bid_order_id = static_cast<uint64_t>(loadI64(body + kBidApplSeqNum));
+  trade.ask_order_id = static_cast<uint64_t>(loadI64(body + kOfferApplSeqNum));
+  trade.price = loadI64(body + kLastPx);
+  trade.secid = parseSecurityID(body + kSecurityID);
+  trade.quantity = quantityOf(body + kLastQty);
+  // 行情不带主动方向，委托号较大（后到）的一方为主动方
+  trade.aggressive_side = trade.bid_order_id > trade.ask_order_id;
+  trade.type = body[kExecType] == '4' ? TradeType::CANCEL : TradeType::FILL;
+  return Event::of(trade);
+}
+
+}  // namespace
+
+size_t FeedDecoder::decode(const char* data, size_t size, Event* out,
+                           size_t capacity, size_t& consumed) {
+  size_t count = 0;
+  size_t offset = 0;
+  while (count < capacity && size - offset >= kHeaderSize) {
+    uint32_t msgType = loadU32(data + offset);
+    uint32_t bodyLength = loadU32(data + offset + 4);
+    size_t length = kHeaderSize + size_t{bodyLength} + kChecksumSize;
+    if (size - offset < length) {
+      break;
+    }
+    const char* body = data + offset + kHeaderSize;
+    // 消息体可能带扩展字段，只要求不短于已知部分
+    if (msgType == kFeedOrderMsgType && bodyLength >= order_body::kSize) {
+      out[count++] = decodeOrder(body);
+    } else if (msgType == kFeedTradeMsgType &&
+               bodyLength >= trade_body::kSize) {
+      out[count++] = decodeTrade(body);
+    }
+    offset += length;
+  }
+  consumed = offset;
+  return count;
+}
+
+LiveFeed::LiveFeed(MarketType type, bool matching)
+    : type_(type), matching_(matching) {}
+
+OrderBookReconstructor& LiveFeed::reconstructorOf(uint32_t secid) {
+  if (const uint32_t* slot = index_.find(secid)) {
+    return *reconstructors_[*slot];
+  }
+  index_.insert(secid, static_cast<uint32_t>(reconstructors_.size()));
+  MarketType type = type_ != MarketType::UNKNOWN ? type_ : szseMarketOf(secid);
+  // 实时行情不知道全天委托量，空簿起步按需增长
+  reconstructors_.push_back(createReconstructor(type, matching_, 0));
+  OrderBookReconstructor& reconstructor = *reconstructors_.back();
+  if (securityHandler_) {
+    securityHandler_(secid, reconstructor);
+  }
+  return reconstructor;
+}
+
+size_t LiveFeed::onBlock(const char* data, size_t size) {
+  constexpr size_t kBatch = 256;
+  Event batch[kBatch];
+  size_t applied = 0;
+  while (size > 0) {
+    size_t consumed = 0;
+    size_t count = FeedDecoder::decode(data, size, batch, kBatch, consumed);
+    if (consumed == 0) {
+      ++truncatedBlocks_;
+      break;
+    }
+    // 同一证券的连续事件一次交给重建器
+    for (size_t begin = 0, end = 0; begin < count; begin = end) {
+      uint32_t secid = batch[begin].secid();
+      end = begin + 1;
+      while (end < count && batch[end].secid() == secid) ++end;
+      reconstructorOf(secid).processEvents(batch + begin, end - begin);
+    }
+    applied += count;
+    data += consumed;
+    size -= consumed;
+  }
+  events_ += applied;
+  return applied;
+}
+
+const OrderBookReconstructor* LiveFeed::find(uint32_t secid) const {
+  const uint32_t* slot = index_.find(secid);
+  return slot != nullptr ? reconstructors_[*slot].get() : nullptr;
+}
+
+}  // namespace orderbook
@@ -1,20 +1,113 @@
 #include "main_board_reconstructor.h"
 
-#include <iostream>
-
 namespace orderbook {
-MainBoardReconstructor::MainBoardReconstructor() {}
+// 按调用方给出的预期委托量预分配订单池和委托号索引，冷门证券不必占用整块内存
+MainBoardReconstructor::MainBoardReconstructor(bool matching,
+                                               size_t expectedOrders)
+    : matching_(matching), book_(PriceGrid{}, expectedOrders) {}
 
 MainBoardReconstructor::~MainBoardReconstructor() {}
 
-void MainBoardReconstructor::processOrder(Order order) {
-  std::cout << "Processing order: " << order.order_id
-            << " at price: " << order.price << std::endl;
+void MainBoardReconstructor::processOrder(const Order& order) {
+  executions_.clear();
+  enter(BookOrder{order.order_id, order.price, order.quantity,
+                  static_cast<int8_t>(order.is_buy ? 1 : 2)},
+        order.type, order.timestamp);
+}
+
+void MainBoardReconstructor::enter(BookOrder order, OrderType type,
+                                   uint64_t timestamp) {
+  if (matching_) {
+    size_t first = executions_.size();
+    book_.submitOrder(order, type, timestamp, executions_);
+    if (executions_.size() > first) {
+      lastPrice_ = executions_.back().price;
+    }
+    return;
+  }
+  switch (type) {
+    case OrderType::LIMIT:
+      break;
+    case OrderType::MARKET:
+      // 对手方最优价格申报，以对手方最优价作为申报价格，对手方为空时撤销
+      order.price = order.side == 1 ? book_.bestAsk() : book_.bestBid();
+      if (order.price == 0) {
+        return;
+      }
+      break;
+    case OrderType::OWN_BEST:
+      // 本方最优价格申报，以本方最优价作为申报价格，本方为空时撤销
+      order.price = order.side == 1 ? book_.bestBid() : book_.bestAsk();
+      if (order.price == 0) {
+        return;
+      }
+      break;
+    default:
+      // IOC/FOK 剩余部分立即撤销，不会进入订单簿
+      return;
+  }
+  book_.addOrder(order);
+}
+
+ReconstructorState MainBoardReconstructor::saveState(
+    std::vector<BookOrder>& orders) const {
+  ReconstructorState state{};
+  size_t first = orders.size();
+  book_.exportOrders(orders);
+  state.grid = book_.grid();
+  state.phase = book_.phase();
+  state.lastPrice = lastPrice_;
+  state.resting = orders.size() - first;
+  return state;
+}
+
+void MainBoardReconstructor::restoreState(const ReconstructorState& state,
+                                          const BookOrder* orders) {
+  book_.restore(state.grid, state.phase, orders, state.resting);
+  lastPrice_ = state.lastPrice;
+  executions_.clear();
+}
+
+size_t MainBoardReconstructor::processEvents(const Event* events,
+                                            size_t count) {
+  return dispatchEvents(*this, events, count);
+}
+
+void MainBoardReconstructor::prefetch(const Event& event) const {
+  if (event.type == EventType::ORDER) {
+    // 新委托要写入的索引槽位和价位
+    book_.prefetchOrder(event.order.order_id);
+    book_.prefetchLevel(event.order.is_buy, event.order.price);
+  } else if (event.trade.type == TradeType::CANCEL) {
+    book_.prefetchOrder(event.trade.bid_order_id != 0
+                            ? event.trade.bid_order_id
+                            : event.trade.ask_order_id);
+  } else {
+    book_.prefetchOrder(event.trade.bid_order_id);
+    book_.prefetchOrder(event.trade.ask_order_id);
+  }
 }
 
-void MainBoardReconstructor::processTrade(Trade trade) {
-  std::cout << "Processing trade: " << trade.trade_id
-            << " at price: " << trade.price << std::endl;
+void MainBoardReconstructor::processTrade(const Trade& trade) {
+  executions_.clear();
+  if (matching_) {
+    // 成交由订单簿自行撮合产生，逐笔成交只用来推进阶段和撤单
+    book_.advance(trade.timestamp, executions_);
+    if (!executions_.empty()) {
+      lastPrice_ = executions_.back().price;
+    }
+    if (trade.type == TradeType::FILL) {
+      return;
+    }
+  }
+  if (trade.type == TradeType::CANCEL) {
+    book_.cancelOrder(trade.bid_order_id != 0 ? trade.bid_order_id
+                                              : trade.ask_order_id);
+    return;
+  }
+  lastPrice_ = trade.price;
+  book_.fillOrder(trade.bid_order_id, trade.quantity);
+  book_.fillOrder(trade.ask_order_id, trade.quantity);
 }
 
-}  // namespace orderbook
\ No newline at end of file
+}  // namespace orderbook
@@ -0,0 +1,304 @@
+#include "map_order_book.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+namespace orderbook {
+
+OrderIterator::OrderIterator(OrderBookMap& price_map, bool is_end)
+    : map_iter(is_end ? price_map.end() : price_map.begin()),
+      map_end(price_map.end()) {
+  if (map_iter != map_end) {
+    list_iter = map_iter->second.orders.begin();
+    advance_to_valid();
+  }
+}
+
+OrderIterator& OrderIterator::operator++() {
+  if (map_iter == map_end) return *this;
+
+  ++list_iter;
+  advance_to_valid();
+  return *this;
+}
+
+void OrderIterator::advance_to_valid() {
+  // 跳过空列表或已到列表末尾的情况
+  while (map_iter != map_end) {
+    if (list_iter != map_iter->second.orders.end()) {
+      return;
+    }
+
+    ++map_iter;
+    if (map_iter != map_end) {
+      list_iter = map_iter->second.orders.begin();
+    }
+  }
+}
+
+static OrderIterator begin(OrderBookMap& price_map) {
+  return OrderIterator(price_map);
+}
+
+static OrderIterator end(OrderBookMap& price_map) {
+  return OrderIterator(price_map, true);
+}
+
+OrderBookStatus MapOrderBook::flushStatus() {
+  if (bidPriceMaps.empty() || askPriceMaps.empty()) {
+    return OrderBookStatus{};
+  } else if (bidPriceMaps.begin()->first < askPriceMaps.begin()->first) {
+    return OrderBookStatus{};
+  }
+
+  OrderBookStatus status{};
+  std::map<uint64_t, uint64_t, std::greater<>> bidPrefixSum;
+  std::map<uint64_t, uint64_t, std::less<>> askPrefixSum;
+  uint64_t totalBidQuantity = 0;
+  uint64_t totalAskQuantity = 0;
+  for (const auto& [price, level] : bidPriceMaps) {
+    bidPrefixSum[price] = totalBidQuantity;
+    totalBidQuantity += level.quantity;
+  }
+  bidPrefixSum[0] =
+      totalBidQuantity;  // Add a zero price level for easier calculations
+
+  for (const auto& [price, level] : askPriceMaps) {
+    askPrefixSum[price] = totalAskQuantity;
+    totalAskQuantity += level.quantity;
+  }
+  askPrefixSum[INT64_MAX] =
+      totalAskQuantity;  // Add a max price level for easier calculations
+
+  OptimPriceInfo optimPriceInfo;
+  optimPriceInfo.expectedDealQuantity = -1;
+
+  auto bidIt = bidPrefixSum.begin();
+  int64_t minBidPrice = askPrefixSum.begin()->first;
+  while (bidIt != bidPrefixSum.end()) {
+    if (bidIt->first < static_cast<uint64_t>(minBidPrice)) {
+      break;
+    }
+    int64_t curPrice = bidIt->first;
+    int64_t currBuy = bidPriceMaps[curPrice].quantity;
+    int64_t buyAboveQuantity = bidIt->second;
+
+    auto askIt = askPrefixSum.lower_bound(curPrice);
+    assert(askIt != askPrefixSum.end());
+    int64_t currSell = askIt->first == static_cast<uint64_t>(curPrice)
+                           ? askPriceMaps[curPrice].quantity
+                           : 0;
+    int64_t askBelowQuantity = askIt->second;
+    bool ok = true;
+    if (buyAboveQuantity + currBuy > askBelowQuantity + currSell) {
+      if (buyAboveQuantity > askBelowQuantity + currSell) {
+        ok = false;
+      }
+    } else if (buyAboveQuantity + currBuy < askBelowQuantity + currSell) {
+      if (askBelowQuantity > buyAboveQuantity + currBuy) {
+        ok = false;
+      }
+    }
+
+    if (!ok) {
+      ++bidIt;
+      continue;
+    }
+
+    int64_t expectedDealQuantity = std::min(buyAboveQuantity + currBuy,
+                                            askBelowQuantity + currSell);
+    OptimPriceInfo current{curPrice,
+                           expectedDealQuantity,
+                           buyAboveQuantity,
+                           askBelowQuantity,
+                           currBuy + buyAboveQuantity - expectedDealQuantity,
+                           currSell + askBelowQuantity - expectedDealQuantity};
+    if (current > optimPriceInfo) {
+      optimPriceInfo = current;
+    }
+    ++bidIt;
+  }
+
+  auto askIt = askPrefixSum.begin();
+  int64_t maxAskPrice = bidPrefixSum.begin()->first;
+  while (askIt != askPrefixSum.end()) {
+    if (askIt->first > static_cast<uint64_t>(maxAskPrice)) {
+      break;
+    }
+    int64_t curPrice = askIt->first;
+    int64_t currSell = askPriceMaps[curPrice].quantity;
+    int64_t askBelowQuantity = askIt->second;
+
+    auto bidIt = bidPrefixSum.lower_bound(curPrice);
+    assert(bidIt != bidPrefixSum.end());
+    int64_t currBuy = bidIt->first == static_cast<uint64_t>(curPrice)
+                          ? bidPriceMaps[curPrice].quantity
+                          : 0;
+    int64_t buyAboveQuantity = bidIt->second;
+    bool ok = true;
+    if (buyAboveQuantity + currBuy > askBelowQuantity + currSell) {
+      if (buyAboveQuantity > askBelowQuantity + currSell) {
+        ok = false;
+      }
+    } else if (buyAboveQuantity + currBuy < askBelowQuantity + currSell) {
+      if (askBelowQuantity > buyAboveQuantity + currBuy) {
+        ok = false;
+      }
+    }
+    if (!ok) {
+      ++askIt;
+      continue;
+    }
+    int64_t expectedDealQuantity = std::min(buyAboveQuantity + currBuy,
+                                            askBelowQuantity + currSell);
+    OptimPriceInfo current{curPrice,
+                           expectedDealQuantity,
+                           buyAboveQuantity,
+                           askBelowQuantity,
+                           currBuy + buyAboveQuantity - expectedDealQuantity,
+                           currSell + askBelowQuantity - expectedDealQuantity};
+    if (current > optimPriceInfo) {
+      optimPriceInfo = current;
+    }
+    ++askIt;
+  }
+
+  status.lpr = optimPriceInfo.dealPrice;
+  status.cvl = optimPriceInfo.expectedDealQuantity;
+
+  status.cto = status.cvl * optimPriceInfo.dealPrice / 10000;
+
+  int64_t tradeCount = 0;
+
+  OrderIterator buyOrderIt = begin(bidPriceMaps);
+  OrderIterator sellOrderIt = begin(askPriceMaps);
+  BookOrder buyOrder = *buyOrderIt;
+  BookOrder sellOrder = *sellOrderIt;
+
+  while (1) {
+    if (buyOrder.price < sellOrder.price) {
+      break;
+    }
+    uint64_t tradeVolume = std::min(buyOrder.quantity, sellOrder.quantity);
+    buyOrder.quantity -= tradeVolume;
+    sellOrder.quantity -= tradeVolume;
+    ++tradeCount;
+
+    bool finished = false;
+    if (buyOrder.quantity == 0) {
+      ++buyOrderIt;
+      if (buyOrderIt == end(bidPriceMaps)) {
+        finished = true;
+      } else {
+        buyOrder = *buyOrderIt;
+      }
+    }
+    if (sellOrder.quantity == 0) {
+      ++sellOrderIt;
+      if (sellOrderIt == end(askPriceMaps)) {
+        finished = true;
+      } else {
+        sellOrder = *sellOrderIt;
+      }
+    }
+    if (finished) {
+      break;
+    }
+  }
+
+  status.nts = tradeCount;
+
+  auto bidIter = buyOrderIt.getMapIter();
+  auto askIter = sellOrderIt.getMapIter();
+  int count = 4;
+  while (bidIter != bidPriceMaps.end() && count >= 0) {
+    status.bp[count] = bidIter->first;
+
+    if (bidIter->first == static_cast<uint64_t>(optimPriceInfo.dealPrice)) {
+      status.bs[count] = optimPriceInfo.buyDealPriceLeftQuantity;
+    } else {
+      status.bs[count] = bidIter->second.quantity;
+    }
+    --count;
+    ++bidIter;
+  }
+
+  count = 0;
+  while (askIter != askPriceMaps.end() && count < 5) {
+    status.ap[count] = askIter->first;
+    if (askIter->first == static_cast<uint64_t>(optimPriceInfo.dealPrice)) {
+      status.as[count] = optimPriceInfo.askDealPriceRightQuantity;
+    } else {
+      status.as[count] = askIter->second.quantity;
+    }
+    ++count;
+    ++askIter;
+  }
+
+  return status;
+}
+
+void MapOrderBook::addOrder(const BookOrder& order) {
+  if (order.side == 1) {  // Buy order
+    auto& priceLevel = bidPriceMaps[order.price];
+    priceLevel.quantity += order.quantity;
+    priceLevel.orders.push_back(order);
+  } else if (order.side == 2) {  // Sell order
+    auto& priceLevel = askPriceMaps[order.price];
+    priceLevel.quantity += order.quantity;
+    priceLevel.orders.push_back(order);
+  }
+}
+
+bool MapOrderBook::cancelOrder(uint64_t id) {
+  for (OrderBookMap* side : {&bidPriceMaps, &askPriceMaps}) {
+    for (auto level = side->begin(); level != side->end(); ++level) {
+      auto& orders = level->second.orders;
+      for (auto it = orders.begin(); it != orders.end(); ++it) {
+        if (it->id != id) {
+          continue;
+        }
+        level->second.quantity -= it->quantity;
+        orders.erase(it);
+        if (orders.empty()) {
+          side->erase(level);
+        }
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void MapOrderBook::insertOrder(const BookOrder& order) {
+  addOrder(order);
+  auto obs = flushStatus();
+  obs.printInfo();
+}
+
+void MapOrderBook::printOrderBook() const {
+  std::cout << "Bid Price Levels:\n";
+  for (const auto& [price, level] : bidPriceMaps) {
+    std::cout << "Price: " << price << ", Quantity: " << level.quantity
+              << "\n";
+    for (const auto& order : level.orders) {
+      std::cout << "  Order ID: " << order.id
+                << ", Quantity: " << order.quantity << "\n";
+    }
+  }
+  std::cout << "----------------------------\n";
+  std::cout << "\nAsk Price Levels:\n";
+  for (const auto& [price, level] : askPriceMaps) {
+    std::cout << "Price: " << price << ", Quantity: " << level.quantity
+              << "\n";
+    for (const auto& order : level.orders) {
+      std::cout << "  Order ID: " << order.id
+                << ", Quantity: " << order.quantity << "\n";
+    }
+  }
+}
+
+}  // namespace orderbook
@@ -0,0 +1,254 @@
+#include "parallel_replay.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "reconstructor.h"
+
+namespace orderbook {
+
+namespace {
+
+struct ReplayJob {
+  size_t slot;
+  uint64_t size;
+  RecordRange<Order> orders;
+  RecordRange<Trade> trades;
+};
+
+// 合并两个按 secid 升序的索引，得到全部证券及其记录范围
+std::vector<ReplayJob> collectJobs(const OrderFile& orders,
+                                   const TradeFile& trades) {
+  std::vector<ReplayJob> jobs;
+  auto o = orders.securities().begin();
+  auto oEnd = orders.securities().end();
+  auto t = trades.securities().begin();
+  auto tEnd = trades.securities().end();
+  while (o != oEnd || t != tEnd) {
+    uint32_t secid = t == tEnd || (o != oEnd && o->secid < t->secid)
+                         ? o->secid
+                         : t->secid;
+    ReplayJob job{jobs.size(), 0, {}, {}};
+    if (o != oEnd && o->secid == secid) {
+      job.orders = orders.select(secid);
+      ++o;
+    }
+    if (t != tEnd && t->secid == secid) {
+      job.trades = trades.select(secid);
+      ++t;
+    }
+    job.size = job.orders.size() + job.trades.size();
+    jobs.push_back(job);
+  }
+  return jobs;
+}
+
+// 进程允许使用的 CPU，taskset/cgroup 限制下不是 0..n-1
+std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+void pinToCpu(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  // 绑核失败（容器限制等）不影响正确性，忽略
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+}  // namespace
+
+void parallelFor(size_t count, unsigned workers,
+                 const std::function<void(size_t)>& work) {
+  std::vector<int> cpus = allowedCpus();
+  if (workers == 0) {
+    workers = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency())
+                           : static_cast<unsigned>(cpus.size());
+  }
+  workers = static_cast<unsigned>(
+      std::min<size_t>(workers, std::max<size_t>(count, 1)));
+
+  std::atomic<size_t> next{0};
+  auto run = [&](unsigned worker) {
+    // 0 号在调用线程上执行，不改它的亲和性；其余线程依次绑到允许的 CPU 上，
+    // 跳过调用线程可能占用的第一个
+    if (worker != 0 && cpus.size() > 1) {
+      pinToCpu(cpus[worker % cpus.size()]);
+    }
+    for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next.fetch_add(1, std::memory_order_relaxed)) {
+      work(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  for (unsigned i = 1; i < workers; ++i) {
+    threads.emplace_back(run, i);
+  }
+  run(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+std::vector<SecuritySnapshot> replayAll(const OrderFile& orders,
+                                        const TradeFile& trades,
+                                        MarketType type, unsigned workers,
+                                        bool matching) {
+  std::vector<ReplayJob> jobs = collectJobs(orders, trades);
+  std::vector<SecuritySnapshot> snapshots(jobs.size());
+  std::stable_sort(jobs.begin(), jobs.end(),
+                   [](const ReplayJob& lhs, const ReplayJob& rhs) {
+                     return lhs.size > rhs.size;
+                   });
+
+  parallelFor(jobs.size(), workers, [&](size_t i) {
+    const ReplayJob& job = jobs[i];
+    auto reconstructor =
+        createReconstructor(type, matching, job.orders.size());
+    replay(*reconstructor, job.orders, job.trades);
+
+    const OrderBook& book = reconstructor->book();
+    SecuritySnapshot& snapshot = snapshots[job.slot];
+    snapshot.secid = !job.orders.empty() ? job.orders.begin()->secid
+                                         : job.trades.begin()->secid;
+    snapshot.orders = job.orders.size();
+    snapshot.trades = job.trades.size();
+    snapshot.bestBid = book.bestBid();
+    snapshot.bestAsk = book.bestAsk();
+    snapshot.status = book.auctionStatus();
+  });
+  return snapshots;
+}
+
+ReplaySession::ReplaySession(const OrderFile& orders, const TradeFile& trades,
+                             MarketType type, bool matching)
+    : orderFile_(orders), tradeFile_(trades), type_(type), matching_(matching) {
+  std::vector<ReplayJob> jobs = collectJobs(orders, trades);
+  securities_.reserve(jobs.size());
+  for (const ReplayJob& job : jobs) {
+    uint32_t secid = !job.orders.empty() ? job.orders.begin()->secid
+                                         : job.trades.begin()->secid;
+    // 所有证券的订单簿同时存在，不按全天记录数预分配：簿内只有挂单，
+    // 远少于委托总数，空簿起步按实际挂单量增长
+    securities_.push_back(Security{secid, job.orders, job.trades, 0, 0,
+                                   createReconstructor(type, matching, 0)});
+  }
+  std::stable_sort(jobs.begin(), jobs.end(),
+                   [](const ReplayJob& lhs, const ReplayJob& rhs) {
+                     return lhs.size > rhs.size;
+                   });
+  for (const ReplayJob& job : jobs) {
+    schedule_.push_back(job.slot);
+  }
+}
+
+ReplaySession::ReplaySession(const OrderFile& orders, const TradeFile& trades,
+                             MarketType type, const CheckpointImage& image,
+                             unsigned workers, bool matching)
+    : ReplaySession(orders, trades, type, matching) {
+  if (image.marketType() != type || image.matching() != matching) {
+    throw std::runtime_error("checkpoint was taken with another reconstructor");
+  }
+  if (image.orderRecords() != orders.size() ||
+      image.tradeRecords() != trades.size() ||
+      image.securities().size() != securities_.size()) {
+    throw std::runtime_error("checkpoint was taken on different files");
+  }
+  const CheckpointEntry* entries = image.securities().begin();
+  for (size_t i = 0; i < securities_.size(); ++i) {
+    Security& security = securities_[i];
+    if (entries[i].secid != security.secid ||
+        entries[i].ordersApplied > security.orders.size() ||
+        entries[i].tradesApplied > security.trades.size()) {
+      throw std::runtime_error("checkpoint was taken on different files");
+    }
+    security.ordersApplied = entries[i].ordersApplied;
+    security.tradesApplied = entries[i].tradesApplied;
+  }
+  // 各证券的订单簿互相独立，按与重放相同的顺序并行重建
+  parallelFor(schedule_.size(), workers, [&](size_t i) {
+    size_t slot = schedule_[i];
+    image.restore(entries[slot], *securities_[slot].reconstructor);
+  });
+  position_ = image.timestamp();
+}
+
+void ReplaySession::advance(uint64_t until, unsigned workers) {
+  parallelFor(schedule_.size(), workers, [&](size_t i) {
+    Security& security = securities_[schedule_[i]];
+    RecordRange<Order> orders{security.orders.begin() + security.ordersApplied,
+                              security.orders.end()};
+    RecordRange<Trade> trades{security.trades.begin() + security.tradesApplied,
+                              security.trades.end()};
+    constexpr size_t kBatch = 256;
+    Event batch[kBatch];
+    EventMerger merger(orders, trades);
+    while (size_t size = merger.next(batch, kBatch, until)) {
+      security.reconstructor->processEvents(batch, size);
+      for (size_t j = 0; j < size; ++j) {
+        if (batch[j].type == EventType::ORDER) {
+          ++security.ordersApplied;
+        } else {
+          ++security.tradesApplied;
+        }
+      }
+    }
+  });
+  position_ = std::max(position_, until);
+}
+
+uint64_t ReplaySession::pending() const {
+  uint64_t next = UINT64_MAX;
+  for (const Security& security : securities_) {
+    if (security.ordersApplied < security.orders.size()) {
+      next = std::min(
+          next, security.orders.begin()[security.ordersApplied].timestamp);
+    }
+    if (security.tradesApplied < security.trades.size()) {
+      next = std::min(
+          next, security.trades.begin()[security.tradesApplied].timestamp);
+    }
+  }
+  return next;
+}
+
+bool ReplaySession::checkpoint(const std::string& path) const {
+  CheckpointWriter writer;
+  for (const Security& security : securities_) {
+    writer.add(security.secid, security.ordersApplied, security.tradesApplied,
+               *security.reconstructor);
+  }
+  return writer.write(path, position_, type_, matching_, orderFile_.size(),
+                      tradeFile_.size());
+}
+
+std::vector<SecuritySnapshot> ReplaySession::snapshots() const {
+  std::vector<SecuritySnapshot> snapshots;
+  snapshots.reserve(securities_.size());
+  for (const Security& security : securities_) {
+    const OrderBook& book = security.reconstructor->book();
+    snapshots.push_back(SecuritySnapshot{
+        security.secid, security.orders.size(), security.trades.size(),
+        book.bestBid(), book.bestAsk(), book.auctionStatus()});
+  }
+  return snapshots;
+}
+
+}  // namespace orderbook
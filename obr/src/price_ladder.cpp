@@ -0,0 +1,28 @@
+#include "price_ladder.h"
+
+#include <utility>
+
+namespace orderbook {
+
+void PriceLadder::reset(PriceGrid grid) {
+  grid_ = grid;
+  levels_.assign(grid.levels, LadderLevel{});
+  words_.assign((grid.levels + 63) / 64, 0);
+  summary_.assign((words_.size() + 63) / 64, 0);
+  occupied_ = 0;
+}
+
+void PriceLadder::rebase(PriceGrid grid) {
+  PriceGrid old = grid_;
+  std::vector<LadderLevel> levels = std::move(levels_);
+  reset(grid);
+  for (uint32_t i = 0; i < old.levels; ++i) {
+    if (levels[i].count > 0) {
+      uint32_t index = grid.index(old.price(i));
+      levels_[index] = levels[i];
+      mark(index);
+    }
+  }
+}
+
+}  // namespace orderbook
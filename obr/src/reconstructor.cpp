@@ -1,12 +1,36 @@
 #include "reconstructor.h"
 
+#include "gem_reconstructor.h"
 #include "main_board_reconstructor.h"
 
 namespace orderbook {
-std::unique_ptr<OrderBookReconstructor> createReconstructor(MarketType type) {
+size_t OrderBookReconstructor::processEvents(const Event* events,
+                                             size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const Event& event = events[i];
+    if (event.type == EventType::ORDER) {
+      processOrder(event.order);
+    } else {
+      processTrade(event.trade);
+    }
+    if (snapshotDue()) {
+      snapshotHandler_(book(), event.timestamp());
+    }
+  }
+  if (count != 0 && snapshotHandler_) {
+    snapshotHandler_(book(), events[count - 1].timestamp());
+  }
+  return count;
+}
+
+std::unique_ptr<OrderBookReconstructor> createReconstructor(
+    MarketType type, bool matching, size_t expectedOrders) {
   switch (type) {
     case MarketType::MAIN_BOARD:
-      return std::make_unique<MainBoardReconstructor>();
+      return std::make_unique<MainBoardReconstructor>(matching,
+                                                      expectedOrders);
+    case MarketType::GEM:
+      return std::make_unique<GemReconstructor>(matching, expectedOrders);
     default:
       return nullptr;  // 或者抛出异常
   }
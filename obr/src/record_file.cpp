@@ -0,0 +1,206 @@
+#include "record_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "reconstructor.h"
+
+namespace orderbook {
+
+namespace {
+
+constexpr uint32_t kRecordFileVersion = 2;
+
+template <typename Record>
+constexpr const char* magicOf();
+template <>
+constexpr const char* magicOf<Order>() {
+  return "OBRORDER";
+}
+template <>
+constexpr const char* magicOf<Trade>() {
+  return "OBRTRADE";
+}
+template <>
+constexpr const char* magicOf<MarketSnapshot>() {
+  return "OBRSNAPS";
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + path);
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw std::runtime_error("cannot stat " + path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error("cannot mmap " + path);
+    }
+    data_ = static_cast<const char*>(data);
+  }
+  // 映射建立后即可关闭描述符
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+void MappedFile::willNeed(size_t offset, size_t length) const {
+  if (data_ == nullptr || length == 0) {
+    return;
+  }
+  // madvise 要求页对齐
+  size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  size_t begin = offset / page * page;
+  size_t end = std::min(offset + length, size_);
+  ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_WILLNEED);
+  ::madvise(const_cast<char*>(data_) + begin, end - begin, MADV_SEQUENTIAL);
+}
+
+template <typename Record>
+RecordFile<Record>::RecordFile(const std::string& path) : file_(path) {
+  if (file_.size() < sizeof(RecordFileHeader)) {
+    throw std::runtime_error(path + ": truncated header");
+  }
+  header_ = reinterpret_cast<const RecordFileHeader*>(file_.data());
+  const char* magic = magicOf<Record>();
+  if (std::memcmp(header_->magic, magic, sizeof(header_->magic)) != 0 ||
+      header_->version != kRecordFileVersion ||
+      header_->recordSize != sizeof(Record)) {
+    throw std::runtime_error(path + ": not a " +
+                             std::string(magic, 8) + " file");
+  }
+  // 先按文件大小限定两个计数，下面的乘法不会溢出
+  uint64_t payload = file_.size() - sizeof(RecordFileHeader);
+  if (header_->securityCount > payload / sizeof(SecurityIndex) ||
+      header_->recordCount > payload / sizeof(Record)) {
+    throw std::runtime_error(path + ": size does not match header");
+  }
+  uint64_t indexBytes = header_->securityCount * sizeof(SecurityIndex);
+  uint64_t recordBytes = header_->recordCount * sizeof(Record);
+  if (payload != indexBytes + recordBytes) {
+    throw std::runtime_error(path + ": size does not match header");
+  }
+  index_ = reinterpret_cast<const SecurityIndex*>(file_.data() +
+                                                  sizeof(RecordFileHeader));
+  records_ = reinterpret_cast<const Record*>(file_.data() +
+                                             sizeof(RecordFileHeader) +
+                                             indexBytes);
+  // select 二分查找索引并直接按 first/count 访问映射，每一项都要在记录范围内
+  for (uint64_t i = 0; i < header_->securityCount; ++i) {
+    const SecurityIndex& entry = index_[i];
+    if (entry.first > header_->recordCount ||
+        entry.count > header_->recordCount - entry.first ||
+        (i != 0 && entry.secid <= index_[i - 1].secid)) {
+      throw std::runtime_error(path + ": bad index entry " +
+                               std::to_string(i));
+    }
+  }
+}
+
+template <typename Record>
+RecordRange<Record> RecordFile<Record>::select(uint32_t secid) const {
+  const SecurityIndex* end = index_ + header_->securityCount;
+  const SecurityIndex* entry = std::lower_bound(
+      index_, end, secid,
+      [](const SecurityIndex& lhs, uint32_t id) { return lhs.secid < id; });
+  if (entry == end || entry->secid != secid) {
+    return {};
+  }
+  const Record* first = records_ + entry->first;
+  file_.willNeed(reinterpret_cast<const char*>(first) - file_.data(),
+                 entry->count * sizeof(Record));
+  return {first, first + entry->count};
+}
+
+template class RecordFile<Order>;
+template class RecordFile<Trade>;
+template class RecordFile<MarketSnapshot>;
+
+template <typename Record>
+bool writeRecordFile(const std::string& path, Record* records, size_t count) {
+  std::stable_sort(records, records + count,
+                   [](const Record& lhs, const Record& rhs) {
+                     if (lhs.secid != rhs.secid) return lhs.secid < rhs.secid;
+                     return lhs.timestamp < rhs.timestamp;
+                   });
+  std::vector<SecurityIndex> index;
+  for (size_t i = 0; i < count; ++i) {
+    if (index.empty() || index.back().secid != records[i].secid) {
+      index.push_back(SecurityIndex{records[i].secid, 0, i, 0});
+    }
+    ++index.back().count;
+  }
+
+  RecordFileHeader header{};
+  std::memcpy(header.magic, magicOf<Record>(), sizeof(header.magic));
+  header.version = kRecordFileVersion;
+  header.recordSize = sizeof(Record);
+  header.recordCount = count;
+  header.securityCount = index.size();
+
+  std::FILE* out = std::fopen(path.c_str(), "wb");
+  if (out == nullptr) {
+    return false;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+            std::fwrite(index.data(), sizeof(SecurityIndex), index.size(),
+                        out) == index.size() &&
+            std::fwrite(records, sizeof(Record), count, out) == count;
+  return std::fclose(out) == 0 && ok;
+}
+
+template bool writeRecordFile(const std::string&, Order*, size_t);
+template bool writeRecordFile(const std::string&, Trade*, size_t);
+template bool writeRecordFile(const std::string&, MarketSnapshot*, size_t);
+
+size_t EventMerger::next(Event* out, size_t capacity, uint64_t until) {
+  size_t size = 0;
+  while (size < capacity) {
+    bool haveOrder = order_ != orderEnd_ && order_->timestamp <= until;
+    bool haveTrade = trade_ != tradeEnd_ && trade_->timestamp <= until;
+    if (haveOrder &&
+        (!haveTrade || order_->timestamp <= trade_->timestamp)) {
+      out[size++] = Event::of(*order_++);
+    } else if (haveTrade) {
+      out[size++] = Event::of(*trade_++);
+    } else {
+      break;
+    }
+  }
+  return size;
+}
+
+size_t replay(OrderBookReconstructor& reconstructor, RecordRange<Order> orders,
+              RecordRange<Trade> trades) {
+  // 归并成批后整批交给重建器，每批只有一次虚调用
+  constexpr size_t kBatch = 256;
+  Event batch[kBatch];
+  EventMerger merger(orders, trades);
+  while (size_t size = merger.next(batch, kBatch)) {
+    reconstructor.processEvents(batch, size);
+  }
+  return orders.size() + trades.size();
+}
+
+}  // namespace orderbook
@@ -0,0 +1,97 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "reconstructor.h"
+
+namespace orderbook {
+
+SnapshotRing::SnapshotRing(size_t depth, size_t capacity)
+    : depth_(depth),
+      stride_((BookSnapshot::frameSize(depth) + 7) / 8 * 8) {
+  size_t frames = 1;
+  while (frames < capacity) {
+    frames <<= 1;
+  }
+  mask_ = frames - 1;
+  frames_ = std::make_unique<uint64_t[]>(frames * stride_ / 8);
+}
+
+BookSnapshot* SnapshotRing::claim() {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head - cachedTail_ > mask_) {
+    cachedTail_ = tail_.load(std::memory_order_acquire);
+    if (head - cachedTail_ > mask_) {
+      return nullptr;
+    }
+  }
+  return frame(head);
+}
+
+const BookSnapshot* SnapshotRing::peek() {
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail == cachedHead_) {
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    if (tail == cachedHead_) {
+      return nullptr;
+    }
+  }
+  return frame(tail);
+}
+
+SnapshotPublisher::SnapshotPublisher(SnapshotRing& ring, uint32_t secid)
+    : ring_(ring),
+      secid_(secid),
+      last_(2 * ring.depth()),
+      current_(2 * ring.depth()) {}
+
+bool SnapshotPublisher::publish(const OrderBook& book, uint64_t timestamp) {
+  size_t depth = ring_.depth();
+  DepthLevel* bids = current_.data();
+  DepthLevel* asks = bids + depth;
+  // 集合竞价期间订单簿交叉，发布虚拟撮合后剩余的档位，与交易所行情一致
+  size_t bidCount = book.residualDepth(true, bids, depth);
+  size_t askCount = book.residualDepth(false, asks, depth);
+  // 可见档位没有变化时不发布
+  if (sequence_ != 0 && bidCount == bidCount_ && askCount == askCount_ &&
+      std::equal(bids, bids + bidCount, last_.data()) &&
+      std::equal(asks, asks + askCount, last_.data() + depth)) {
+    return false;
+  }
+
+  BookSnapshot* snapshot = ring_.claim();
+  if (snapshot == nullptr) {
+    ++dropped_;
+    return false;
+  }
+  snapshot->timestamp = timestamp;
+  snapshot->sequence = ++sequence_;
+  snapshot->secid = secid_;
+  snapshot->depth = static_cast<uint16_t>(depth);
+  snapshot->bidCount = static_cast<uint16_t>(bidCount);
+  snapshot->askCount = static_cast<uint16_t>(askCount);
+  std::memcpy(snapshot->bids(), bids, bidCount * sizeof(DepthLevel));
+  std::memset(snapshot->bids() + bidCount, 0,
+              (depth - bidCount) * sizeof(DepthLevel));
+  std::memcpy(snapshot->asks(), asks, askCount * sizeof(DepthLevel));
+  std::memset(snapshot->asks() + askCount, 0,
+              (depth - askCount) * sizeof(DepthLevel));
+  ring_.commit();
+
+  current_.swap(last_);
+  bidCount_ = bidCount;
+  askCount_ = askCount;
+  return true;
+}
+
+void SnapshotPublisher::attach(OrderBookReconstructor& reconstructor,
+                               uint32_t everyEvents) {
+  reconstructor.setSnapshotHandler(
+      [this](const OrderBook& book, uint64_t timestamp) {
+        publish(book, timestamp);
+      },
+      everyEvents);
+}
+
+}  // namespace orderbook
@@ -0,0 +1,177 @@
+#include "verifier.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+
+#include "parallel_replay.h"
+#include "reconstructor.h"
+
+namespace orderbook {
+
+namespace {
+
+constexpr size_t kLevels = MarketSnapshot::kDepth;
+
+// 只比较档位数组，时间戳和 secid 由调用方保证一致
+constexpr size_t kBookOffset = offsetof(MarketSnapshot, bidPrice);
+constexpr size_t kBookBytes = sizeof(MarketSnapshot) - kBookOffset;
+
+struct VerifyJob {
+  size_t slot;
+  uint64_t size;
+  uint32_t secid;
+};
+
+void describe(size_t offset, Divergence& divergence) {
+  // offset 落在哪个数组、哪一档
+  static const char* const kFields[] = {"bidPrice", "bidQuantity", "askPrice",
+                                        "askQuantity"};
+  size_t slot = (offset - kBookOffset) / sizeof(int64_t);
+  size_t field = slot / kLevels;
+  size_t level = slot % kLevels;
+  divergence.field = kFields[field];
+  divergence.level = static_cast<uint32_t>(level + 1);
+
+  const MarketSnapshot& e = divergence.exchange;
+  const MarketSnapshot& r = divergence.reconstructed;
+  switch (field) {
+    case 0:
+      divergence.expected = e.bidPrice[level];
+      divergence.actual = r.bidPrice[level];
+      break;
+    case 1:
+      divergence.expected = static_cast<int64_t>(e.bidQuantity[level]);
+      divergence.actual = static_cast<int64_t>(r.bidQuantity[level]);
+      break;
+    case 2:
+      divergence.expected = e.askPrice[level];
+      divergence.actual = r.askPrice[level];
+      break;
+    default:
+      divergence.expected = static_cast<int64_t>(e.askQuantity[level]);
+      divergence.actual = static_cast<int64_t>(r.askQuantity[level]);
+      break;
+  }
+}
+
+}  // namespace
+
+size_t firstMismatch(const void* lhs, const void* rhs, size_t size) {
+  const char* a = static_cast<const char*>(lhs);
+  const char* b = static_cast<const char*>(rhs);
+  size_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    unsigned equal =
+        static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+    if (equal != 0xffff) {
+      return i + static_cast<size_t>(__builtin_ctz(~equal));
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    if (a[i] != b[i]) {
+      return i;
+    }
+  }
+  return size;
+}
+
+MarketSnapshot captureSnapshot(const OrderBook& book, uint32_t secid,
+                               uint64_t timestamp) {
+  MarketSnapshot snapshot{};
+  snapshot.timestamp = timestamp;
+  snapshot.secid = secid;
+
+  // 集合竞价期间交易所发布虚拟撮合后的剩余档位，非撮合模式下连续竞价中
+  // 交叉的订单簿也按同样方式比对；不交叉时两者相同
+  DepthLevel levels[kLevels];
+  size_t bids = book.residualDepth(true, levels, kLevels);
+  for (size_t i = 0; i < bids; ++i) {
+    snapshot.bidPrice[i] = levels[i].price;
+    snapshot.bidQuantity[i] = levels[i].quantity;
+  }
+  size_t asks = book.residualDepth(false, levels, kLevels);
+  for (size_t i = 0; i < asks; ++i) {
+    snapshot.askPrice[i] = levels[i].price;
+    snapshot.askQuantity[i] = levels[i].quantity;
+  }
+  return snapshot;
+}
+
+VerifyResult verify(OrderBookReconstructor& reconstructor,
+                    RecordRange<Order> orders, RecordRange<Trade> trades,
+                    RecordRange<MarketSnapshot> snapshots) {
+  VerifyResult result{};
+  if (snapshots.empty()) {
+    return result;
+  }
+  result.secid = snapshots.begin()->secid;
+
+  constexpr size_t kBatch = 256;
+  Event batch[kBatch];
+  EventMerger merger(orders, trades);
+  uint64_t events = 0;
+  for (const MarketSnapshot& expected : snapshots) {
+    while (size_t size = merger.next(batch, kBatch, expected.timestamp)) {
+      reconstructor.processEvents(batch, size);
+      events += size;
+    }
+    MarketSnapshot actual = captureSnapshot(reconstructor.book(),
+                                            expected.secid, expected.timestamp);
+    size_t offset =
+        firstMismatch(reinterpret_cast<const char*>(&expected) + kBookOffset,
+                      reinterpret_cast<const char*>(&actual) + kBookOffset,
+                      kBookBytes);
+    ++result.snapshots;
+    if (offset != kBookBytes) {
+      Divergence& divergence = result.divergence;
+      divergence.snapshot = result.snapshots - 1;
+      divergence.events = events;
+      divergence.exchange = expected;
+      divergence.reconstructed = actual;
+      describe(kBookOffset + offset, divergence);
+      result.diverged = true;
+      break;
+    }
+  }
+  return result;
+}
+
+std::vector<VerifyResult> verifyAll(const OrderFile& orders,
+                                    const TradeFile& trades,
+                                    const SnapshotFile& snapshots,
+                                    MarketType type, unsigned workers,
+                                    bool matching) {
+  std::vector<VerifyJob> jobs;
+  for (const SecurityIndex& entry : snapshots.securities()) {
+    uint32_t secid = entry.secid;
+    jobs.push_back(VerifyJob{jobs.size(),
+                             orders.select(secid).size() +
+                                 trades.select(secid).size(),
+                             secid});
+  }
+  std::vector<VerifyResult> results(jobs.size());
+  std::stable_sort(jobs.begin(), jobs.end(),
+                   [](const VerifyJob& lhs, const VerifyJob& rhs) {
+                     return lhs.size > rhs.size;
+                   });
+
+  parallelFor(jobs.size(), workers, [&](size_t i) {
+    const VerifyJob& job = jobs[i];
+    auto reconstructor =
+        createReconstructor(type, matching, orders.select(job.secid).size());
+    results[job.slot] =
+        verify(*reconstructor, orders.select(job.secid),
+               trades.select(job.secid), snapshots.select(job.secid));
+  });
+  return results;
+}
+
+}  // namespace orderbook
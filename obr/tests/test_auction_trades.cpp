@@ -0,0 +1,206 @@
+/**
+ * @file test_auction_trades.cpp
+ * @brief auction status of OrderBook, trade count (nts) included, against
+ * the brute-force order-by-order walk of MapOrderBook
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "full_order.h"
+#include "map_order_book.h"
+
+namespace orderbook {
+namespace {
+
+BookOrder buy(uint64_t id, int64_t price, uint64_t quantity) {
+  return BookOrder{id, price, quantity, 1};
+}
+
+BookOrder sell(uint64_t id, int64_t price, uint64_t quantity) {
+  return BookOrder{id, price, quantity, 2};
+}
+
+// 同一份委托重新建簿，没有任何检查点，nts 从头逐笔配对
+uint64_t freshTrades(const OrderBook& book) {
+  std::vector<BookOrder> orders;
+  book.exportOrders(orders);
+  OrderBook fresh;
+  fresh.restore(book.grid(), book.phase(), orders.data(), orders.size());
+  return fresh.auctionStatus().nts;
+}
+
+TEST(AuctionTrades, CountsEveryPairing) {
+  OrderBook book;
+  book.addOrder(buy(1, 100100, 300));
+  book.addOrder(sell(2, 100000, 100));
+  book.addOrder(sell(3, 100000, 100));
+  book.addOrder(sell(4, 100000, 100));
+  EXPECT_EQ(book.auctionStatus().nts, 3u);
+
+  // 两侧同时用完只算一笔
+  book.addOrder(buy(5, 100000, 200));
+  book.addOrder(sell(6, 99900, 200));
+  EXPECT_EQ(book.auctionStatus().nts, 4u);
+
+  book.cancelOrder(1);
+  EXPECT_EQ(book.auctionStatus().nts, 1u);
+  EXPECT_EQ(book.auctionStatus().nts, freshTrades(book));
+}
+
+TEST(AuctionTrades, NotCrossed) {
+  OrderBook book;
+  book.addOrder(buy(1, 100000, 100));
+  book.addOrder(sell(2, 100100, 100));
+  EXPECT_EQ(book.auctionStatus().nts, 0u);
+}
+
+// 委托数量的几种分布：整手小单、分散、少量大单混在一手单里
+uint64_t quantityOf(std::mt19937_64& rng, int shape) {
+  switch (shape) {
+    case 0:
+      return (1 + rng() % 5) * 100;
+    case 1:
+      return (1 + rng() % 100) * 100;
+    default:
+      return rng() % 4 == 0 ? (1 + rng() % 1000) * 100 : 100;
+  }
+}
+
+// 成交笔数、成交量、成交额、成交价和撮合后的五档
+void expectSameStatus(const OrderBookStatus& actual,
+                      const OrderBookStatus& expected) {
+  ASSERT_EQ(actual.nts, expected.nts);
+  ASSERT_EQ(actual.cvl, expected.cvl);
+  ASSERT_EQ(actual.cto, expected.cto);
+  ASSERT_EQ(actual.lpr, expected.lpr);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(actual.bp[i], expected.bp[i]) << "bp " << i;
+    ASSERT_EQ(actual.bs[i], expected.bs[i]) << "bs " << i;
+    ASSERT_EQ(actual.ap[i], expected.ap[i]) << "ap " << i;
+    ASSERT_EQ(actual.as[i], expected.as[i]) << "as " << i;
+  }
+}
+
+TEST(AuctionTrades, MatchesBruteForce) {
+  std::mt19937_64 rng(1);
+  for (int trial = 0; trial < 600; ++trial) {
+    OrderBook book;
+    MapOrderBook reference;
+    std::vector<uint64_t> resting;
+    int orders = 1 + static_cast<int>(rng() % 300);
+    int spread = 1 + static_cast<int>(rng() % 30);
+    int shape = trial % 3;
+    for (int i = 0; i < orders; ++i) {
+      int64_t tick = static_cast<int64_t>(rng() % spread) - spread / 2;
+      BookOrder order{static_cast<uint64_t>(i + 1), 100000 + tick * 100,
+                      quantityOf(rng, shape),
+                      static_cast<int8_t>(rng() % 2 == 0 ? 1 : 2)};
+      book.addOrder(order);
+      reference.addOrder(order);
+      resting.push_back(order.id);
+      if (rng() % 5 == 0) {
+        size_t k = rng() % resting.size();
+        book.cancelOrder(resting[k]);
+        reference.cancelOrder(resting[k]);
+        resting.erase(resting.begin() + static_cast<std::ptrdiff_t>(k));
+      }
+      if (rng() % 3 == 0) {
+        OrderBookStatus actual = book.auctionStatus();
+        OrderBookStatus expected = reference.flushStatus();
+        ASSERT_NO_FATAL_FAILURE(expectSameStatus(actual, expected))
+            << "trial " << trial;
+      }
+    }
+  }
+}
+
+TEST(AuctionTrades, IncrementalMatchesFullWalk) {
+  std::mt19937_64 rng(2);
+  for (int trial = 0; trial < 300; ++trial) {
+    OrderBook book;
+    std::vector<uint64_t> resting;
+    int orders = 1 + static_cast<int>(rng() % 300);
+    int spread = 1 + static_cast<int>(rng() % 30);
+    for (int i = 0; i < orders; ++i) {
+      int64_t tick = static_cast<int64_t>(rng() % spread) - spread / 2;
+      // 偶尔落在价格网格之外，触发网格扩展
+      if (rng() % 50 == 0) {
+        tick += static_cast<int64_t>(rng() % 1800) - 900;
+      }
+      BookOrder order{static_cast<uint64_t>(i + 1), 100000 + tick * 100,
+                      quantityOf(rng, trial % 3),
+                      static_cast<int8_t>(rng() % 2 == 0 ? 1 : 2)};
+      book.addOrder(order);
+      resting.push_back(order.id);
+      size_t k = rng() % resting.size();
+      switch (rng() % 8) {
+        case 0:
+          book.cancelOrder(resting[k]);
+          resting.erase(resting.begin() + static_cast<std::ptrdiff_t>(k));
+          break;
+        case 1:
+          // 部分成交保留队列位置
+          if (const BookOrder* partial = book.findOrder(resting[k])) {
+            book.fillOrder(resting[k], partial->quantity / 2);
+          }
+          break;
+        default:
+          break;
+      }
+      if (rng() % 3 == 0) {
+        ASSERT_EQ(book.auctionStatus().nts, freshTrades(book))
+            << "trial " << trial;
+      }
+    }
+  }
+}
+
+double secondsOf(std::chrono::steady_clock::duration elapsed) {
+  return std::chrono::duration<double>(elapsed).count();
+}
+
+// 散户小单排在最优买价，卖方是少量大单：每笔大单吞下一长串小单，
+// 最优价位上的新委托不应逐笔重走整个交叉区
+TEST(AuctionTrades, BestLevelInsertSkipsAbsorbedOrders) {
+  constexpr uint64_t kSmall = 50000;
+  constexpr int kInserts = 100;
+  OrderBook book;
+  uint64_t id = 0;
+  for (uint64_t i = 0; i < kSmall; ++i) {
+    book.addOrder(buy(++id, 100100, 100));
+  }
+  for (int i = 0; i < 20; ++i) {
+    book.addOrder(sell(++id, 100000, 300000));
+  }
+
+  // 没有任何缓存时的一次完整配对作为基准
+  std::vector<BookOrder> orders;
+  book.exportOrders(orders);
+  OrderBook fresh;
+  fresh.restore(book.grid(), book.phase(), orders.data(), orders.size());
+  auto start = std::chrono::steady_clock::now();
+  uint64_t trades = fresh.auctionStatus().nts;
+  double fullWalk = secondsOf(std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(book.auctionStatus().nts, trades);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kInserts; ++i) {
+    book.addOrder(buy(++id, 100100, 100));
+    trades = book.auctionStatus().nts;
+  }
+  double inserts = secondsOf(std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(trades, freshTrades(book));
+  // 每次都重走交叉区约为 kInserts 倍的基准
+  EXPECT_LT(inserts, fullWalk * kInserts / 10);
+}
+
+}  // namespace
+}  // namespace orderbook
@@ -0,0 +1,118 @@
+/**
+ * @file test_checkpoint.cpp
+ * @brief checkpoint images: write/restore round trip, and headers or entries
+ * whose counts overflow are rejected instead of read out of bounds
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "checkpoint.h"
+
+namespace orderbook {
+namespace {
+
+constexpr uint64_t kContinuous = 20250707100000000ULL;
+
+Order orderOf(uint64_t id, int64_t price, uint32_t quantity, bool isBuy) {
+  Order order{};
+  order.timestamp = kContinuous + id;
+  order.order_id = id;
+  order.price = price;
+  order.secid = 1;
+  order.quantity = quantity;
+  order.is_buy = isBuy;
+  order.type = OrderType::LIMIT;
+  return order;
+}
+
+class CheckpointFile : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path = ::testing::TempDir() + "test_checkpoint.chkpt";
+    Order orders[] = {orderOf(1, 100000, 100, true),
+                      orderOf(2, 99900, 200, true),
+                      orderOf(3, 100100, 300, false)};
+    source = createReconstructor(MarketType::MAIN_BOARD);
+    replay(*source, {orders, orders + 3}, {});
+    CheckpointWriter writer;
+    writer.add(1, 3, 0, *source);
+    ASSERT_TRUE(writer.write(path, kContinuous + 3, MarketType::MAIN_BOARD,
+                             false, 3, 0));
+    std::ifstream in(path, std::ios::binary);
+    image.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  // 改写镜像中的一个字段后写回
+  template <typename T>
+  void patch(size_t offset, T value) {
+    std::memcpy(image.data() + offset, &value, sizeof(value));
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+  }
+
+  std::string path;
+  std::unique_ptr<OrderBookReconstructor> source;
+  std::vector<char> image;
+};
+
+TEST_F(CheckpointFile, RoundTrip) {
+  CheckpointImage checkpoint(path);
+  EXPECT_EQ(checkpoint.timestamp(), kContinuous + 3);
+  ASSERT_EQ(checkpoint.securities().size(), 1u);
+  auto restored = createReconstructor(MarketType::MAIN_BOARD);
+  checkpoint.restore(*checkpoint.securities().begin(), *restored);
+
+  std::vector<BookOrder> expected;
+  std::vector<BookOrder> actual;
+  source->book().exportOrders(expected);
+  restored->book().exportOrders(actual);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].id, expected[i].id);
+    EXPECT_EQ(actual[i].price, expected[i].price);
+    EXPECT_EQ(actual[i].quantity, expected[i].quantity);
+  }
+  EXPECT_FALSE(std::ifstream(path + ".tmp").good());
+}
+
+// orderCount 加 2^59 后乘以 32 字节回绕，总大小仍与文件一致
+TEST_F(CheckpointFile, RejectsWrappingHeaderCount) {
+  uint64_t orderCount;
+  std::memcpy(&orderCount,
+              image.data() + offsetof(CheckpointHeader, orderCount),
+              sizeof(orderCount));
+  patch(offsetof(CheckpointHeader, orderCount), orderCount + (1ULL << 59));
+  EXPECT_THROW(CheckpointImage{path}, std::runtime_error);
+}
+
+// first + resting + parked 回绕到 0
+TEST_F(CheckpointFile, RejectsWrappingOrderRange) {
+  CheckpointEntry entry;
+  size_t offset = sizeof(CheckpointHeader);
+  std::memcpy(static_cast<void*>(&entry), image.data() + offset,
+              sizeof(entry));
+  patch(offset + offsetof(CheckpointEntry, state) +
+            offsetof(ReconstructorState, parked),
+        0 - entry.first - entry.state.resting);
+  EXPECT_THROW(CheckpointImage{path}, std::runtime_error);
+}
+
+}  // namespace
+}  // namespace orderbook
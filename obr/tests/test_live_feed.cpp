@@ -0,0 +1,406 @@
+/**
+ * @file test_live_feed.cpp
+ * @brief FeedDecoder framing and field layout, and LiveFeed books against a
+ * replay of the same records
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "gem_reconstructor.h"
+#include "live_feed.h"
+#include "reconstructor.h"
+#include "record_file.h"
+
+namespace orderbook {
+namespace {
+
+constexpr uint64_t kContinuous = 20250707100000000ULL;  // 连续竞价时段
+
+// 按交易所二进制格式拼出一个解压后的数据块，整数大端
+class BlockWriter {
+ public:
+  // extra 为消息体末尾的扩展字段字节数
+  void order(const Order& order, size_t extra = 0) {
+    header(kFeedOrderMsgType, 51 + extra);
+    u16(1);
+    i64(static_cast<int64_t>(order.order_id));
+    text("011", 3);
+    security(order.secid);
+    text("102", 4);
+    i64(order.price);
+    i64(static_cast<int64_t>(order.quantity) * 100);
+    block_.push_back(order.is_buy ? '1' : '2');
+    i64(static_cast<int64_t>(order.timestamp));
+    block_.push_back(ordType(order.type));
+    block_.insert(block_.end(), extra, '\0');
+    u32(0);
+  }
+
+  void trade(const Trade& trade, size_t extra = 0) {
+    header(kFeedTradeMsgType, 66 + extra);
+    u16(1);
+    i64(static_cast<int64_t>(trade.trade_id));
+    text("011", 3);
+    i64(static_cast<int64_t>(trade.bid_order_id));
+    i64(static_cast<int64_t>(trade.ask_order_id));
+    security(trade.secid);
+    text("102", 4);
+    i64(trade.price);
+    i64(static_cast<int64_t>(trade.quantity) * 100);
+    block_.push_back(trade.type == TradeType::CANCEL ? '4' : 'F');
+    i64(static_cast<int64_t>(trade.timestamp));
+    block_.insert(block_.end(), extra, '\0');
+    u32(0);
+  }
+
+  // 不解码的消息类型，如行情快照
+  void other(uint32_t type, size_t length) {
+    header(type, static_cast<uint32_t>(length));
+    block_.insert(block_.end(), length, 'x');
+    u32(0);
+  }
+
+  std::vector<char>& block() { return block_; }
+
+ private:
+  static char ordType(OrderType type) {
+    switch (type) {
+      case OrderType::MARKET:
+        return '1';
+      case OrderType::OWN_BEST:
+        return 'U';
+      default:
+        return '2';
+    }
+  }
+
+  void header(uint32_t type, size_t length) {
+    u32(type);
+    u32(static_cast<uint32_t>(length));
+  }
+
+  void u16(uint16_t value) { put(__builtin_bswap16(value)); }
+  void u32(uint32_t value) { put(__builtin_bswap32(value)); }
+  void i64(int64_t value) {
+    put(__builtin_bswap64(static_cast<uint64_t>(value)));
+  }
+
+  void text(const char* value, size_t size) {
+    block_.insert(block_.end(), value, value + size);
+  }
+
+  void security(uint32_t secid) {
+    char code[9];
+    std::snprintf(code, sizeof(code), "%06u  ", secid);
+    text(code, 8);
+  }
+
+  template <typename T>
+  void put(T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    block_.insert(block_.end(), bytes, bytes + sizeof(value));
+  }
+
+  std::vector<char> block_;
+};
+
+Order orderOf(uint32_t secid, uint64_t timestamp, uint64_t id, int64_t price,
+              uint32_t quantity, bool isBuy, OrderType type) {
+  Order order{};
+  order.timestamp = timestamp;
+  order.order_id = id;
+  order.price = price;
+  order.secid = secid;
+  order.quantity = quantity;
+  order.is_buy = isBuy;
+  order.type = type;
+  return order;
+}
+
+Trade tradeOf(uint32_t secid, uint64_t timestamp, uint64_t id, uint64_t bid,
+              uint64_t ask, int64_t price, uint32_t quantity, TradeType type) {
+  Trade trade{};
+  trade.timestamp = timestamp;
+  trade.trade_id = id;
+  trade.bid_order_id = bid;
+  trade.ask_order_id = ask;
+  trade.price = price;
+  trade.secid = secid;
+  trade.quantity = quantity;
+  trade.aggressive_side = bid > ask;
+  trade.type = type;
+  return trade;
+}
+
+void expectSameOrder(const Order& actual, const Order& expected) {
+  EXPECT_EQ(actual.timestamp, expected.timestamp);
+  EXPECT_EQ(actual.order_id, expected.order_id);
+  EXPECT_EQ(actual.price, expected.price);
+  EXPECT_EQ(actual.secid, expected.secid);
+  EXPECT_EQ(actual.quantity, expected.quantity);
+  EXPECT_EQ(actual.is_buy, expected.is_buy);
+  EXPECT_EQ(actual.type, expected.type);
+}
+
+void expectSameTrade(const Trade& actual, const Trade& expected) {
+  EXPECT_EQ(actual.timestamp, expected.timestamp);
+  EXPECT_EQ(actual.trade_id, expected.trade_id);
+  EXPECT_EQ(actual.bid_order_id, expected.bid_order_id);
+  EXPECT_EQ(actual.ask_order_id, expected.ask_order_id);
+  EXPECT_EQ(actual.price, expected.price);
+  EXPECT_EQ(actual.secid, expected.secid);
+  EXPECT_EQ(actual.quantity, expected.quantity);
+  EXPECT_EQ(actual.aggressive_side, expected.aggressive_side);
+  EXPECT_EQ(actual.type, expected.type);
+}
+
+TEST(FeedDecoder, FieldOffsets) {
+  Order orders[] = {
+      orderOf(300750, kContinuous + 1, 123456789012, 1234500, 300, true,
+              OrderType::LIMIT),
+      orderOf(1, kContinuous + 2, 7, 0, 1200, false, OrderType::MARKET),
+      orderOf(2, kContinuous + 3, 8, 99900, 100, true, OrderType::OWN_BEST)};
+  Trade trades[] = {tradeOf(300750, kContinuous + 4, 1ULL << 40, 11, 12,
+                            1234500, 200, TradeType::FILL),
+                    tradeOf(1, kContinuous + 5, 99, 0, 7, 0, 1200,
+                            TradeType::CANCEL)};
+  BlockWriter writer;
+  for (const Order& order : orders) writer.order(order);
+  for (const Trade& trade : trades) writer.trade(trade);
+
+  Event events[8];
+  size_t consumed = 0;
+  std::vector<char>& block = writer.block();
+  ASSERT_EQ(FeedDecoder::decode(block.data(), block.size(), events, 8,
+                                consumed),
+            5u);
+  EXPECT_EQ(consumed, block.size());
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(events[i].type, EventType::ORDER);
+    expectSameOrder(events[i].order, orders[i]);
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(events[3 + i].type, EventType::TRADE);
+    expectSameTrade(events[3 + i].trade, trades[i]);
+  }
+}
+
+TEST(FeedDecoder, SkipsUnknownTypes) {
+  Order order = orderOf(1, kContinuous, 1, 100000, 100, true, OrderType::LIMIT);
+  BlockWriter writer;
+  writer.other(300111, 0);
+  writer.order(order);
+  writer.other(309011, 200);
+  // 类型是委托但消息体短于已知字段，同样按 BodyLength 跳过
+  writer.other(kFeedOrderMsgType, 20);
+  writer.order(order);
+
+  Event events[8];
+  size_t consumed = 0;
+  std::vector<char>& block = writer.block();
+  ASSERT_EQ(FeedDecoder::decode(block.data(), block.size(), events, 8,
+                                consumed),
+            2u);
+  EXPECT_EQ(consumed, block.size());
+  expectSameOrder(events[0].order, order);
+  expectSameOrder(events[1].order, order);
+}
+
+TEST(FeedDecoder, ExtendedBodyLength) {
+  Order order = orderOf(1, kContinuous, 5, 100000, 100, false,
+                        OrderType::LIMIT);
+  Trade trade = tradeOf(1, kContinuous, 6, 0, 5, 0, 100, TradeType::CANCEL);
+  BlockWriter writer;
+  writer.order(order, 9);
+  writer.trade(trade, 30);
+  writer.order(order);
+
+  Event events[8];
+  size_t consumed = 0;
+  std::vector<char>& block = writer.block();
+  ASSERT_EQ(FeedDecoder::decode(block.data(), block.size(), events, 8,
+                                consumed),
+            3u);
+  EXPECT_EQ(consumed, block.size());
+  expectSameOrder(events[0].order, order);
+  expectSameTrade(events[1].trade, trade);
+  expectSameOrder(events[2].order, order);
+}
+
+TEST(FeedDecoder, TruncatedLastMessage) {
+  Order order = orderOf(1, kContinuous, 1, 100000, 100, true, OrderType::LIMIT);
+  BlockWriter writer;
+  writer.order(order);
+  writer.order(order);
+  size_t complete = writer.block().size();
+  writer.order(order);
+  std::vector<char>& block = writer.block();
+
+  Event events[8];
+  // 截断在消息头、消息体和校验和中
+  for (size_t cut : {complete + 3, complete + 30, block.size() - 1}) {
+    size_t consumed = 0;
+    EXPECT_EQ(FeedDecoder::decode(block.data(), cut, events, 8, consumed), 2u);
+    EXPECT_EQ(consumed, complete);
+  }
+
+  LiveFeed feed(MarketType::MAIN_BOARD);
+  EXPECT_EQ(feed.onBlock(block.data(), block.size() - 1), 2u);
+  EXPECT_EQ(feed.truncatedBlocks(), 1u);
+}
+
+TEST(FeedDecoder, StopsAtCapacity) {
+  Order order = orderOf(1, kContinuous, 1, 100000, 100, true, OrderType::LIMIT);
+  BlockWriter writer;
+  writer.order(order);
+  size_t first = writer.block().size();
+  writer.order(order);
+  std::vector<char>& block = writer.block();
+
+  Event events[1];
+  size_t consumed = 0;
+  EXPECT_EQ(FeedDecoder::decode(block.data(), block.size(), events, 1,
+                                consumed),
+            1u);
+  EXPECT_EQ(consumed, first);
+}
+
+TEST(LiveFeed, BoardFromSecurityCode) {
+  BlockWriter writer;
+  writer.order(orderOf(300750, kContinuous, 1, 100000, 100, true,
+                       OrderType::LIMIT));
+  writer.order(orderOf(1, kContinuous, 2, 100000, 100, true,
+                       OrderType::LIMIT));
+  LiveFeed feed;
+  feed.onBlock(writer.block().data(), writer.block().size());
+  EXPECT_NE(dynamic_cast<const GemReconstructor*>(feed.find(300750)),
+            nullptr);
+  ASSERT_NE(feed.find(1), nullptr);
+  EXPECT_EQ(dynamic_cast<const GemReconstructor*>(feed.find(1)), nullptr);
+}
+
+void expectSameBook(const OrderBook& actual, const OrderBook& expected) {
+  DepthLevel a[MarketSnapshot::kDepth];
+  DepthLevel e[MarketSnapshot::kDepth];
+  for (bool isBuy : {true, false}) {
+    size_t count = actual.depth(isBuy, a, MarketSnapshot::kDepth);
+    ASSERT_EQ(count, expected.depth(isBuy, e, MarketSnapshot::kDepth));
+    for (size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(a[i], e[i]) << (isBuy ? "bid " : "ask ") << i;
+    }
+  }
+  EXPECT_EQ(actual.orderCount(), expected.orderCount());
+}
+
+// 同一组委托和成交编码后经 LiveFeed 得到的订单簿，与按记录重放的一致
+TEST(LiveFeed, SameBooksAsReplay) {
+  const uint32_t securities[] = {1, 2, 300750};
+  std::mt19937_64 rng(15);
+  std::vector<Order> orders;
+  std::vector<Trade> trades;
+  BlockWriter writer;
+  struct Resting {
+    uint32_t secid;
+    uint64_t id;
+    int64_t price;
+    uint32_t quantity;
+    bool buy;
+  };
+  std::vector<Resting> resting;
+  uint64_t timestamp = kContinuous;
+  uint64_t nextId = 1;
+  for (int i = 0; i < 5000; ++i) {
+    ++timestamp;
+    uint32_t secid = securities[rng() % 3];
+    size_t k = resting.empty() ? 0 : rng() % resting.size();
+    switch (resting.empty() ? 0 : rng() % 4) {
+      case 1: {
+        // 撤单
+        Resting order = resting[k];
+        resting.erase(resting.begin() + static_cast<std::ptrdiff_t>(k));
+        trades.push_back(tradeOf(order.secid, timestamp, nextId++,
+                                 order.buy ? order.id : 0,
+                                 order.buy ? 0 : order.id, 0, order.quantity,
+                                 TradeType::CANCEL));
+        writer.trade(trades.back());
+        break;
+      }
+      case 2: {
+        // 部分成交，对手方为不在簿中的委托号
+        Resting& order = resting[k];
+        uint64_t other = nextId++;
+        uint32_t quantity = order.quantity / 2;
+        trades.push_back(tradeOf(order.secid, timestamp, nextId++,
+                                 order.buy ? order.id : other,
+                                 order.buy ? other : order.id, order.price,
+                                 quantity, TradeType::FILL));
+        order.quantity -= quantity;
+        writer.trade(trades.back());
+        break;
+      }
+      default: {
+        bool buy = rng() % 2 == 0;
+        int64_t price = buy ? 100000 - static_cast<int64_t>(rng() % 30) * 100
+                            : 100100 + static_cast<int64_t>(rng() % 30) * 100;
+        OrderType type = rng() % 10 == 0   ? OrderType::MARKET
+                         : rng() % 10 == 0 ? OrderType::OWN_BEST
+                                           : OrderType::LIMIT;
+        // 市价与本方最优的价格字段无意义
+        orders.push_back(orderOf(secid, timestamp, nextId++,
+                                 type == OrderType::LIMIT ? price : 0,
+                                 100 * (1 + rng() % 10), buy, type));
+        writer.order(orders.back());
+        if (type == OrderType::LIMIT) {
+          resting.push_back(Resting{secid, orders.back().order_id, price,
+                                    orders.back().quantity, buy});
+        }
+        break;
+      }
+    }
+  }
+
+  LiveFeed feed;
+  std::vector<char>& block = writer.block();
+  EXPECT_EQ(feed.onBlock(block.data(), block.size()),
+            orders.size() + trades.size());
+  EXPECT_EQ(feed.truncatedBlocks(), 0u);
+
+  auto bySecurity = [](const auto& lhs, const auto& rhs) {
+    return lhs.secid < rhs.secid;
+  };
+  std::stable_sort(orders.begin(), orders.end(), bySecurity);
+  std::stable_sort(trades.begin(), trades.end(), bySecurity);
+  for (uint32_t secid : securities) {
+    Order order{};
+    order.secid = secid;
+    auto orderRange =
+        std::equal_range(orders.begin(), orders.end(), order, bySecurity);
+    Trade trade{};
+    trade.secid = secid;
+    auto tradeRange =
+        std::equal_range(trades.begin(), trades.end(), trade, bySecurity);
+
+    auto reconstructor = createReconstructor(szseMarketOf(secid));
+    replay(*reconstructor,
+           {orders.data() + (orderRange.first - orders.begin()),
+            orders.data() + (orderRange.second - orders.begin())},
+           {trades.data() + (tradeRange.first - trades.begin()),
+            trades.data() + (tradeRange.second - trades.begin())});
+    SCOPED_TRACE(secid);
+    ASSERT_NE(feed.find(secid), nullptr);
+    EXPECT_GT(reconstructor->book().orderCount(), 0u);
+    expectSameBook(feed.find(secid)->book(), reconstructor->book());
+  }
+}
+
+}  // namespace
+}  // namespace orderbook
@@ -0,0 +1,239 @@
+/**
+ * @file test_matching.cpp
+ * @brief matching mode: phase boundaries, OrderBook::submitOrder by order
+ * type, the opening uncross and replayAll with matching
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "full_order.h"
+#include "parallel_replay.h"
+#include "record_file.h"
+#include "trading_phase.h"
+
+namespace orderbook {
+namespace {
+
+constexpr uint64_t kDay = 20250707ULL * 1000000000ULL;
+
+// HHMMSSmmm 换成当天的完整时间戳
+uint64_t at(uint64_t time) { return kDay + time; }
+
+BookOrder buy(uint64_t id, int64_t price, uint64_t quantity) {
+  return BookOrder{id, price, quantity, 1};
+}
+
+BookOrder sell(uint64_t id, int64_t price, uint64_t quantity) {
+  return BookOrder{id, price, quantity, 2};
+}
+
+// 连续竞价中的卖一 10.00、卖二 10.01、卖三 10.02，各 100 股
+class ContinuousBook : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    submit(sell(1, 100000, 100), OrderType::LIMIT);
+    submit(sell(2, 100100, 100), OrderType::LIMIT);
+    submit(sell(3, 100200, 100), OrderType::LIMIT);
+    executions.clear();
+  }
+
+  uint64_t submit(const BookOrder& order, OrderType type) {
+    return book.submitOrder(order, type, at(100000000), executions);
+  }
+
+  OrderBook book;
+  std::vector<Execution> executions;
+};
+
+TEST(TradingPhase, Boundaries) {
+  EXPECT_EQ(phaseAt(at(91459999)), TradingPhase::CLOSED);
+  EXPECT_EQ(phaseAt(at(91500000)), TradingPhase::OPENING_AUCTION);
+  EXPECT_EQ(phaseAt(at(92459999)), TradingPhase::OPENING_AUCTION);
+  EXPECT_EQ(phaseAt(at(92500000)), TradingPhase::CONTINUOUS);
+  EXPECT_EQ(phaseAt(at(145659999)), TradingPhase::CONTINUOUS);
+  EXPECT_EQ(phaseAt(at(145700000)), TradingPhase::CLOSING_AUCTION);
+  EXPECT_EQ(phaseAt(at(145959999)), TradingPhase::CLOSING_AUCTION);
+  EXPECT_EQ(phaseAt(at(150000000)), TradingPhase::CLOSED);
+}
+
+TEST_F(ContinuousBook, LimitRestsRemainder) {
+  EXPECT_EQ(submit(buy(10, 100100, 250), OrderType::LIMIT), 200u);
+  ASSERT_EQ(executions.size(), 2u);
+  EXPECT_EQ(executions[0].sellId, 1u);
+  EXPECT_EQ(executions[0].price, 100000);
+  EXPECT_EQ(executions[1].sellId, 2u);
+  EXPECT_EQ(executions[1].price, 100100);
+  EXPECT_EQ(book.bestBid(), 100100);
+  EXPECT_EQ(book.findOrder(10)->quantity, 50u);
+}
+
+TEST_F(ContinuousBook, MarketStopsAtBestAndRestsThere) {
+  // 对手方最优：只成交卖一，剩余挂在卖一价
+  EXPECT_EQ(submit(buy(10, 0, 150), OrderType::MARKET), 100u);
+  ASSERT_EQ(executions.size(), 1u);
+  EXPECT_EQ(executions[0].price, 100000);
+  EXPECT_EQ(book.bestBid(), 100000);
+  EXPECT_EQ(book.bestAsk(), 100100);
+  EXPECT_EQ(book.findOrder(10)->quantity, 50u);
+}
+
+TEST_F(ContinuousBook, MarketRejectedOnEmptySide) {
+  EXPECT_EQ(submit(sell(10, 0, 100), OrderType::MARKET), 0u);
+  EXPECT_TRUE(executions.empty());
+  EXPECT_EQ(book.findOrder(10), nullptr);
+  EXPECT_EQ(book.bestBid(), 0);
+}
+
+TEST_F(ContinuousBook, OwnBestJoinsOwnSide) {
+  // 本方最优：以卖一 10.00 定价，不与买方成交，排在同价位之后
+  submit(buy(9, 99900, 100), OrderType::LIMIT);
+  EXPECT_EQ(submit(sell(10, 0, 100), OrderType::OWN_BEST), 0u);
+  EXPECT_TRUE(executions.empty());
+  ASSERT_NE(book.findOrder(10), nullptr);
+  EXPECT_EQ(book.findOrder(10)->price, 100000);
+
+  EXPECT_EQ(submit(buy(11, 0, 100), OrderType::OWN_BEST), 0u);
+  EXPECT_EQ(book.findOrder(11)->price, 99900);
+
+  // 本方为空时撤销
+  book.cancelOrder(9);
+  book.cancelOrder(11);
+  EXPECT_EQ(submit(buy(12, 0, 100), OrderType::OWN_BEST), 0u);
+  EXPECT_EQ(book.findOrder(12), nullptr);
+}
+
+TEST_F(ContinuousBook, IocCancelsRemainder) {
+  EXPECT_EQ(submit(buy(10, 100100, 250), OrderType::IOC), 200u);
+  EXPECT_EQ(book.findOrder(10), nullptr);
+  EXPECT_EQ(book.bestBid(), 0);
+  EXPECT_EQ(book.bestAsk(), 100200);
+}
+
+TEST_F(ContinuousBook, IocWithoutPriceSweeps) {
+  EXPECT_EQ(submit(buy(10, 0, 1000), OrderType::IOC), 300u);
+  EXPECT_EQ(executions.size(), 3u);
+  EXPECT_EQ(book.bestAsk(), 0);
+  EXPECT_EQ(book.orderCount(), 0u);
+}
+
+TEST_F(ContinuousBook, FokAllOrNothing) {
+  // 10.01 以内只有 200 股，整笔不成交，订单簿不变
+  EXPECT_EQ(submit(buy(10, 100100, 250), OrderType::FOK), 0u);
+  EXPECT_TRUE(executions.empty());
+  EXPECT_EQ(book.orderCount(), 3u);
+
+  EXPECT_EQ(submit(buy(11, 100100, 200), OrderType::FOK), 200u);
+  EXPECT_EQ(executions.size(), 2u);
+  EXPECT_EQ(book.findOrder(11), nullptr);
+  EXPECT_EQ(book.bestAsk(), 100200);
+}
+
+TEST(Matching, ClosedRejectsEverything) {
+  OrderBook book;
+  std::vector<Execution> executions;
+  EXPECT_EQ(book.submitOrder(buy(1, 100000, 100), OrderType::LIMIT,
+                             at(91000000), executions),
+            0u);
+  EXPECT_EQ(book.orderCount(), 0u);
+}
+
+TEST(Matching, AuctionRestsLimitAndRejectsOthers) {
+  OrderBook book;
+  std::vector<Execution> executions;
+  book.submitOrder(sell(1, 100000, 100), OrderType::LIMIT, at(91600000),
+                   executions);
+  EXPECT_EQ(book.submitOrder(buy(2, 100100, 100), OrderType::LIMIT,
+                             at(91700000), executions),
+            0u);
+  EXPECT_EQ(book.submitOrder(buy(3, 0, 100), OrderType::MARKET, at(91800000),
+                             executions),
+            0u);
+  EXPECT_TRUE(executions.empty());
+  EXPECT_EQ(book.orderCount(), 2u);
+  EXPECT_EQ(book.findOrder(3), nullptr);
+  // 集合竞价期间订单簿交叉
+  EXPECT_GT(book.bestBid(), book.bestAsk());
+}
+
+TEST(Matching, UncrossAtOpen) {
+  OrderBook book;
+  std::vector<Execution> executions;
+  // 10.00 可成交 100，10.01 可成交 200，成交价唯一为 10.01
+  book.submitOrder(buy(1, 100100, 200), OrderType::LIMIT, at(91500000),
+                   executions);
+  book.submitOrder(sell(2, 100000, 100), OrderType::LIMIT, at(92000000),
+                   executions);
+  book.submitOrder(sell(3, 100100, 100), OrderType::LIMIT, at(92459999),
+                   executions);
+  book.submitOrder(buy(4, 99000, 100), OrderType::LIMIT, at(92459999),
+                   executions);
+  EXPECT_TRUE(executions.empty());
+  EXPECT_EQ(book.phase(), TradingPhase::OPENING_AUCTION);
+
+  // 09:25 第一笔委托先触发撮合，再按连续竞价处理自身
+  book.submitOrder(sell(5, 101000, 100), OrderType::LIMIT, at(92500000),
+                   executions);
+  EXPECT_EQ(book.phase(), TradingPhase::CONTINUOUS);
+  ASSERT_EQ(executions.size(), 2u);
+  // 价格优先：先与 10.00 的卖单配对，全部按成交价 10.01 成交
+  EXPECT_EQ(executions[0].buyId, 1u);
+  EXPECT_EQ(executions[0].sellId, 2u);
+  EXPECT_EQ(executions[1].sellId, 3u);
+  for (const Execution& execution : executions) {
+    EXPECT_EQ(execution.price, 100100);
+    EXPECT_EQ(execution.quantity, 100u);
+  }
+  EXPECT_EQ(book.bestBid(), 99000);
+  EXPECT_EQ(book.bestAsk(), 101000);
+}
+
+Order orderOf(uint64_t time, uint64_t id, int64_t price, uint32_t quantity,
+              bool isBuy) {
+  Order order{};
+  order.timestamp = at(time);
+  order.order_id = id;
+  order.price = price;
+  order.secid = 1;
+  order.quantity = quantity;
+  order.is_buy = isBuy;
+  order.type = OrderType::LIMIT;
+  return order;
+}
+
+// 没有成交记录时，只有撮合模式会把交叉的委托成交掉
+TEST(Matching, ReplayAllHonoursMatching) {
+  std::string orderPath = ::testing::TempDir() + "test_matching.order";
+  std::string tradePath = ::testing::TempDir() + "test_matching.trade";
+  Order orders[] = {orderOf(100000000, 1, 100000, 100, false),
+                    orderOf(100000001, 2, 100000, 100, true)};
+  ASSERT_TRUE(writeRecordFile(orderPath, orders, 2));
+  ASSERT_TRUE(writeRecordFile<Trade>(tradePath, nullptr, 0));
+  OrderFile orderFile(orderPath);
+  TradeFile tradeFile(tradePath);
+
+  auto following =
+      replayAll(orderFile, tradeFile, MarketType::MAIN_BOARD, 1, false);
+  ASSERT_EQ(following.size(), 1u);
+  EXPECT_EQ(following[0].bestBid, 100000);
+  EXPECT_EQ(following[0].bestAsk, 100000);
+
+  auto matching =
+      replayAll(orderFile, tradeFile, MarketType::MAIN_BOARD, 1, true);
+  ASSERT_EQ(matching.size(), 1u);
+  EXPECT_EQ(matching[0].bestBid, 0);
+  EXPECT_EQ(matching[0].bestAsk, 0);
+
+  std::remove(orderPath.c_str());
+  std::remove(tradePath.c_str());
+}
+
+}  // namespace
+}  // namespace orderbook
@@ -0,0 +1,94 @@
+/**
+ * @file test_snapshot.cpp
+ * @brief SnapshotPublisher: frames during a call auction show the book left
+ * after the virtual uncross, unchanged books are not published again
+ * @version 0.1
+ * @date 2025-07-07
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include <gtest/gtest.h>
+
+#include "reconstructor.h"
+#include "record_file.h"
+#include "snapshot.h"
+
+namespace orderbook {
+namespace {
+
+constexpr uint64_t kDay = 20250707ULL * 1000000000ULL;
+
+Order orderOf(uint64_t time, uint64_t id, int64_t price, uint32_t quantity,
+              bool isBuy) {
+  Order order{};
+  order.timestamp = kDay + time;
+  order.order_id = id;
+  order.price = price;
+  order.secid = 1;
+  order.quantity = quantity;
+  order.is_buy = isBuy;
+  order.type = OrderType::LIMIT;
+  return order;
+}
+
+// 读完环中所有帧，返回最后一帧；生产者已停止，释放后的帧不会被覆盖
+const BookSnapshot* lastFrame(SnapshotRing& ring, uint64_t& frames) {
+  frames = 0;
+  const BookSnapshot* last = nullptr;
+  while (const BookSnapshot* snapshot = ring.peek()) {
+    last = snapshot;
+    ring.release();
+    ++frames;
+  }
+  return last;
+}
+
+// 开盘集合竞价：10.01 成交 200，买单 1 剩 50，9.90 与 10.10 不参与
+TEST(SnapshotPublisher, AuctionPublishesResidualBook) {
+  Order orders[] = {orderOf(91600000, 1, 100100, 250, true),
+                    orderOf(91700000, 2, 100000, 100, false),
+                    orderOf(91800000, 3, 100100, 100, false),
+                    orderOf(91900000, 4, 99000, 100, true),
+                    orderOf(92000000, 5, 101000, 100, false)};
+  auto reconstructor = createReconstructor(MarketType::MAIN_BOARD);
+  SnapshotRing ring(5, 16);
+  SnapshotPublisher publisher(ring, 1);
+  publisher.attach(*reconstructor, 1);
+  replay(*reconstructor, {orders, orders + 5}, {});
+
+  ASSERT_GT(reconstructor->book().bestBid(), reconstructor->book().bestAsk());
+  uint64_t frames = 0;
+  const BookSnapshot* snapshot = lastFrame(ring, frames);
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(frames, 5u);
+  ASSERT_EQ(snapshot->bidCount, 2u);
+  ASSERT_EQ(snapshot->askCount, 1u);
+  EXPECT_EQ(snapshot->bids()[0], (DepthLevel{100100, 50}));
+  EXPECT_EQ(snapshot->bids()[1], (DepthLevel{99000, 100}));
+  EXPECT_EQ(snapshot->asks()[0], (DepthLevel{101000, 100}));
+  EXPECT_EQ(snapshot->bids()[2], (DepthLevel{0, 0}));
+  EXPECT_LT(snapshot->bids()[0].price, snapshot->asks()[0].price);
+}
+
+TEST(SnapshotPublisher, SkipsUnchangedBook) {
+  Order orders[] = {orderOf(100000000, 1, 100000, 100, true),
+                    orderOf(100000001, 2, 100100, 100, false)};
+  auto reconstructor = createReconstructor(MarketType::MAIN_BOARD);
+  SnapshotRing ring(5, 16);
+  SnapshotPublisher publisher(ring, 1);
+  replay(*reconstructor, {orders, orders + 2}, {});
+
+  EXPECT_TRUE(publisher.publish(reconstructor->book(), kDay + 100000002));
+  EXPECT_FALSE(publisher.publish(reconstructor->book(), kDay + 100000003));
+  uint64_t frames = 0;
+  const BookSnapshot* snapshot = lastFrame(ring, frames);
+  ASSERT_NE(snapshot, nullptr);
+  EXPECT_EQ(frames, 1u);
+  EXPECT_EQ(snapshot->sequence, 1u);
+  EXPECT_EQ(snapshot->bids()[0], (DepthLevel{100000, 100}));
+  EXPECT_EQ(snapshot->asks()[0], (DepthLevel{100100, 100}));
+}
+
+}  // namespace
+}  // namespace orderbook